@@ -0,0 +1,26 @@
+# embed_shaders(<target> <file>...)
+#
+# Embeds files into a target at build time: generates embedded_shaders.h, which defines
+# EmbeddedShaders::FILES, an array of ShaderUtils::EmbeddedFile whose contents are constexpr
+# std::string_views, named by file name. Give it to a ShaderUtils::ShaderLoader.
+# The header is generated again when a file changes.
+
+set(EMBED_SHADERS_SCRIPT "${CMAKE_CURRENT_LIST_DIR}/GenerateEmbeddedShaders.cmake")
+
+function(embed_shaders target)
+    set(output "${CMAKE_CURRENT_BINARY_DIR}/generated/embedded_shaders.h")
+    set(files "")
+    foreach(file IN LISTS ARGN)
+        list(APPEND files "${CMAKE_CURRENT_SOURCE_DIR}/${file}")
+    endforeach()
+
+    add_custom_command(OUTPUT "${output}"
+        COMMAND ${CMAKE_COMMAND} "-DOUTPUT=${output}" "-DFILES=${files}" -P "${EMBED_SHADERS_SCRIPT}"
+        DEPENDS ${files} "${EMBED_SHADERS_SCRIPT}"
+        COMMENT "Embedding the shaders of ${target}"
+        VERBATIM)
+    target_sources(${target}
+        PRIVATE "${output}")
+    target_include_directories(${target}
+        PRIVATE "${CMAKE_CURRENT_BINARY_DIR}/generated")
+endfunction()
@@ -0,0 +1,36 @@
+# Generates the header of embed_shaders, run as a script:
+# cmake -DOUTPUT=<header> -DFILES=<file;...> -P GenerateEmbeddedShaders.cmake
+#
+# Each file becomes a string literal of escaped bytes, one literal per line of the file: no
+# character needs quoting, and its null terminator is left out of the view.
+
+set(arrays "")
+set(entries "")
+foreach(file IN LISTS FILES)
+    get_filename_component(name "${file}" NAME)
+    string(MAKE_C_IDENTIFIER "${name}" identifier)
+    file(READ "${file}" hex HEX)
+    string(LENGTH "${hex}" size)
+    math(EXPR size "${size} / 2")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "\\\\x\\1" escaped "${hex}")
+    string(REPLACE "\\x0a" "\\x0a\"\n        \"" escaped "${escaped}")
+    string(APPEND arrays "    constexpr std::string_view ${identifier} = std::string_view(\n        \"${escaped}\", ${size});\n\n")
+    string(APPEND entries "        {\"${name}\", ${identifier}},\n")
+endforeach()
+
+file(WRITE "${OUTPUT}"
+"/* Generated by GenerateEmbeddedShaders.cmake, do not edit */
+#ifndef _EMBEDDED_SHADERS_H
+#define _EMBEDDED_SHADERS_H
+
+#include <string_view>
+#include \"Base/shader_loader.h\"
+
+namespace EmbeddedShaders
+{
+${arrays}    constexpr ShaderUtils::EmbeddedFile FILES[] = {
+${entries}    };
+}
+
+#endif /* _EMBEDDED_SHADERS_H */
+")
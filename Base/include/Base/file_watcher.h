@@ -0,0 +1,90 @@
+#ifndef _FILE_WATCHER_H
+#define _FILE_WATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ShaderUtils
+{
+
+    /**
+     * @brief The interval between two checks of the files, where inotify is not available
+     */
+    const std::chrono::milliseconds WATCH_PERIOD{250};
+
+    /**
+     * @brief Watches files from a background thread, e.g. the shaders to reload them when saved
+     * On Linux, inotify watches the directories of the files: editors which save by renaming
+     * a new file over the old one are seen as well. Elsewhere, the modification times are
+     * compared every WATCH_PERIOD.
+     */
+    struct FileWatcher
+    {
+
+    private:
+        /**
+         * @brief The files watched, by normalized path, as given to the constructor
+         */
+        std::unordered_map<std::string, std::string> files;
+
+        /**
+         * @brief The files changed since the last `takeChanges`, in order and once each
+         */
+        std::mutex mutex;
+        std::vector<std::string> changes;
+
+        std::thread thread;
+        std::atomic<bool> stopping{false};
+        std::condition_variable stop;
+
+        /**
+         * @brief The inotify descriptor, its watched directories by watch descriptor, and the
+         * pipe which wakes the thread up to stop it (Linux)
+         */
+        int inotify = -1;
+        std::unordered_map<int, std::string> directories;
+        int wakeup[2] = {-1, -1};
+
+        /**
+         * @brief Records a change, if the file is watched
+         */
+        void notify(const std::string &path);
+
+        /**
+         * @brief The loop run by the thread
+         */
+        void run();
+
+    public:
+        /**
+         * @brief Constructor, starts the thread
+         *
+         * @param paths - the files to watch, which may not exist yet
+         */
+        explicit FileWatcher(const std::vector<std::string> &paths);
+
+        /**
+         * @brief Destructor, stops and joins the thread
+         */
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher &) = delete;
+        FileWatcher &operator=(const FileWatcher &) = delete;
+
+        /**
+         * @brief Returns the files changed since the last call, and forgets them
+         * A file written several times in between is returned once.
+         *
+         * @return The paths, as given to the constructor
+         */
+        std::vector<std::string> takeChanges();
+    };
+}
+
+#endif /* _FILE_WATCHER_H */
@@ -0,0 +1,179 @@
+#ifndef _GL_CHECK_H
+#define _GL_CHECK_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+#include "Base/gl_dispatch.h"
+
+/* GL 4.3 / KHR_debug, missing from the GL 4.1 headers */
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT 0x92E0
+#endif
+#ifndef GL_DEBUG_OUTPUT_SYNCHRONOUS
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS 0x8242
+#endif
+#ifndef GL_DEBUG_TYPE_ERROR
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#endif
+
+/**
+ * @brief Checks a GL call, according to the mode set with GLUtils::setCheckMode
+ * Errors are recorded with the call site and logged, nothing is thrown. Compiled out in
+ * release builds (NDEBUG), unless GL_CHECK_RELEASE is defined (CMake: BASE_GL_CHECK_RELEASE).
+ */
+#if defined(NDEBUG) && !defined(GL_CHECK_RELEASE)
+#define GL_CHECK(call) do { \
+    call; \
+} while (false)
+#else
+#define GL_CHECK(call) do { \
+    static const GLUtils::CallSite glCheckSite{#call, __FILE__, __LINE__}; \
+    GLUtils::beginCall(glCheckSite); \
+    call; \
+    GLUtils::endCall(glCheckSite); \
+} while (false)
+#endif
+
+namespace GLUtils
+{
+
+    /**
+     * @brief How GL_CHECK finds the errors
+     */
+    enum CheckMode
+    {
+        /**
+         * @brief Nothing is checked
+         */
+        CHECK_OFF,
+
+        /**
+         * @brief glGetError after every call: a round trip to the driver which may stall it
+         */
+        CHECK_ALWAYS,
+
+        /**
+         * @brief glGetError after every call of one frame in `period`, see `endCheckFrame`
+         */
+        CHECK_SAMPLED,
+
+        /**
+         * @brief The driver reports the errors to a callback, inside the failing call, see
+         * `enableDebugOutput`: no glGetError
+         */
+        CHECK_DEBUG_OUTPUT,
+    };
+
+    /**
+     * @brief The default number of frames between two checked ones, in CHECK_SAMPLED mode
+     */
+    const unsigned int GL_CHECK_PERIOD = 60;
+
+    /**
+     * @brief The number of errors kept by `getErrors`, the next ones are only counted
+     */
+    const std::size_t GL_CHECK_MAX_ERRORS = 64;
+
+    /**
+     * @brief The source of a call checked by GL_CHECK
+     */
+    struct CallSite
+    {
+        const char *call;
+        const char *file;
+        int line;
+    };
+
+    /**
+     * @brief An error found by GL_CHECK
+     */
+    struct CheckError
+    {
+        /**
+         * @brief The call which failed, or an empty site if the driver reported an error
+         * outside of GL_CHECK
+         */
+        CallSite site;
+
+        /**
+         * @brief The glGetError code, or the message ID given by the driver in CHECK_DEBUG_OUTPUT mode
+         */
+        GLenum code;
+
+        /**
+         * @brief The frame, counted by `endCheckFrame`
+         */
+        std::size_t frame;
+
+        /**
+         * @brief The message of the driver, in CHECK_DEBUG_OUTPUT mode
+         */
+        std::string message;
+    };
+
+    /**
+     * @brief Sets how GL_CHECK finds the errors, CHECK_ALWAYS by default
+     *
+     * @param mode - the mode, CHECK_DEBUG_OUTPUT is set by `enableDebugOutput`
+     * @param period - the number of frames between two checked ones, in CHECK_SAMPLED mode
+     */
+    void setCheckMode(CheckMode mode, unsigned int period = GL_CHECK_PERIOD);
+
+    /**
+     * @brief Returns how GL_CHECK finds the errors
+     */
+    CheckMode getCheckMode();
+
+    /**
+     * @brief Installs a KHR_debug callback (GL 4.3) and switches to CHECK_DEBUG_OUTPUT.
+     * The output is synchronous, so that the errors are reported with their call site. Best
+     * with a debug context. Needs a current context.
+     *
+     * @param getProcAddress - the loader of the window system, e.g. glfwGetProcAddress
+     * @return false if the driver has no KHR_debug: the mode is unchanged
+     */
+    bool enableDebugOutput(ProcAddress (*getProcAddress)(const char *));
+
+    /**
+     * @brief Called by GL_CHECK before a call
+     */
+    void beginCall(const CallSite &site);
+
+    /**
+     * @brief Called by GL_CHECK after a call: reads the errors, if this call is checked
+     */
+    void endCall(const CallSite &site);
+
+    /**
+     * @brief Ends a frame: picks whether the next one is checked, in CHECK_SAMPLED mode.
+     * Before a checked frame, the errors left by the unchecked ones are recorded without
+     * a call site.
+     */
+    void endCheckFrame();
+
+    /**
+     * @brief Returns the first GL_CHECK_MAX_ERRORS errors recorded
+     */
+    const std::vector<CheckError> &getErrors();
+
+    /**
+     * @brief Returns the number of errors recorded, including the ones not kept
+     */
+    std::size_t getErrorCount();
+
+    /**
+     * @brief Forgets the errors recorded
+     */
+    void clearErrors();
+}
+
+#endif /* _GL_CHECK_H */
@@ -0,0 +1,303 @@
+#ifndef _GL_DISPATCH_H
+#define _GL_DISPATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+
+/* KHR_parallel_shader_compile, missing from the GL 4.1 headers */
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace GLUtils
+{
+
+    /**
+     * @brief The GL entry points used by Base and the demo frames, named without their `gl` prefix
+     * Base calls GL through `gl()`, so the calls can be sent to another backend than the driver.
+     */
+    struct Dispatch
+    {
+        void (*AttachShader)(GLuint program, GLuint shader);
+        void (*BindBuffer)(GLenum target, GLuint buffer);
+        void (*BindBufferRange)(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+        void (*BindTexture)(GLenum target, GLuint texture);
+        void (*BindVertexArray)(GLuint array);
+        void (*BufferData)(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+        void (*BufferStorage)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+        void (*BufferSubData)(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+        void (*Clear)(GLbitfield mask);
+        void (*ClearColor)(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+        GLenum (*ClientWaitSync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+        void (*CompileShader)(GLuint shader);
+        void (*CopyBufferSubData)(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+        GLuint (*CreateProgram)();
+        GLuint (*CreateShader)(GLenum type);
+        void (*DeleteBuffers)(GLsizei n, const GLuint *buffers);
+        void (*DeleteProgram)(GLuint program);
+        void (*DeleteShader)(GLuint shader);
+        void (*DeleteSync)(GLsync sync);
+        void (*DeleteVertexArrays)(GLsizei n, const GLuint *arrays);
+        void (*DrawArrays)(GLenum mode, GLint first, GLsizei count);
+        void (*DrawArraysInstanced)(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+        void (*DrawElements)(GLenum mode, GLsizei count, GLenum type, const void *indices);
+        void (*EnableVertexAttribArray)(GLuint index);
+        GLsync (*FenceSync)(GLenum condition, GLbitfield flags);
+        void (*GenBuffers)(GLsizei n, GLuint *buffers);
+        void (*GenTextures)(GLsizei n, GLuint *textures);
+        void (*GenVertexArrays)(GLsizei n, GLuint *arrays);
+        void (*GetActiveUniform)(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name);
+        void (*GetActiveUniformBlockName)(GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei *length, GLchar *uniformBlockName);
+        void (*GetActiveUniformBlockiv)(GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint *params);
+        GLenum (*GetError)();
+        void (*GetIntegerv)(GLenum pname, GLint *data);
+        void (*GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+        void (*GetProgramInfoLog)(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog);
+        void (*GetProgramiv)(GLuint program, GLenum pname, GLint *params);
+        void (*GetShaderInfoLog)(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog);
+        void (*GetShaderiv)(GLuint shader, GLenum pname, GLint *params);
+        const GLubyte *(*GetString)(GLenum name);
+        GLuint (*GetUniformBlockIndex)(GLuint program, const GLchar *uniformBlockName);
+        GLint (*GetUniformLocation)(GLuint program, const GLchar *name);
+        void (*LinkProgram)(GLuint program);
+        void *(*MapBufferRange)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+        void (*MultiDrawElements)(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei drawcount);
+        void (*MultiDrawElementsBaseVertex)(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei drawcount, const GLint *basevertex);
+        void (*PolygonMode)(GLenum face, GLenum mode);
+        void (*ProgramBinary)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+        void (*ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+        void (*ProgramUniform1f)(GLuint program, GLint location, GLfloat v0);
+        void (*ProgramUniform1i)(GLuint program, GLint location, GLint v0);
+        void (*ProgramUniform2f)(GLuint program, GLint location, GLfloat v0, GLfloat v1);
+        void (*ProgramUniformMatrix4fv)(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        void (*ShaderSource)(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length);
+        void (*TexBuffer)(GLenum target, GLenum internalformat, GLuint buffer);
+        void (*Uniform1f)(GLint location, GLfloat v0);
+        void (*Uniform1i)(GLint location, GLint v0);
+        void (*Uniform2f)(GLint location, GLfloat v0, GLfloat v1);
+        void (*UniformBlockBinding)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+        void (*UniformMatrix4fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+        GLboolean (*UnmapBuffer)(GLenum target);
+        void (*UseProgram)(GLuint program);
+        void (*VertexAttribDivisor)(GLuint index, GLuint divisor);
+        void (*VertexAttribPointer)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
+        void (*Viewport)(GLint x, GLint y, GLsizei width, GLsizei height);
+    };
+
+    /**
+     * @brief The entry points of Dispatch, the opcodes of the recorded command stream
+     */
+    enum Call
+    {
+        ATTACH_SHADER_CALL,
+        BIND_BUFFER_CALL,
+        BIND_BUFFER_RANGE_CALL,
+        BIND_TEXTURE_CALL,
+        BIND_VERTEX_ARRAY_CALL,
+        BUFFER_DATA_CALL,
+        BUFFER_STORAGE_CALL,
+        BUFFER_SUB_DATA_CALL,
+        CLEAR_CALL,
+        CLEAR_COLOR_CALL,
+        CLIENT_WAIT_SYNC_CALL,
+        COMPILE_SHADER_CALL,
+        COPY_BUFFER_SUB_DATA_CALL,
+        CREATE_PROGRAM_CALL,
+        CREATE_SHADER_CALL,
+        DELETE_BUFFERS_CALL,
+        DELETE_PROGRAM_CALL,
+        DELETE_SHADER_CALL,
+        DELETE_SYNC_CALL,
+        DELETE_VERTEX_ARRAYS_CALL,
+        DRAW_ARRAYS_CALL,
+        DRAW_ARRAYS_INSTANCED_CALL,
+        DRAW_ELEMENTS_CALL,
+        ENABLE_VERTEX_ATTRIB_ARRAY_CALL,
+        FENCE_SYNC_CALL,
+        GEN_BUFFERS_CALL,
+        GEN_TEXTURES_CALL,
+        GEN_VERTEX_ARRAYS_CALL,
+        GET_ACTIVE_UNIFORM_CALL,
+        GET_ACTIVE_UNIFORM_BLOCK_NAME_CALL,
+        GET_ACTIVE_UNIFORM_BLOCKIV_CALL,
+        GET_ERROR_CALL,
+        GET_INTEGERV_CALL,
+        GET_PROGRAM_BINARY_CALL,
+        GET_PROGRAM_INFO_LOG_CALL,
+        GET_PROGRAMIV_CALL,
+        GET_SHADER_INFO_LOG_CALL,
+        GET_SHADERIV_CALL,
+        GET_STRING_CALL,
+        GET_UNIFORM_BLOCK_INDEX_CALL,
+        GET_UNIFORM_LOCATION_CALL,
+        LINK_PROGRAM_CALL,
+        MAP_BUFFER_RANGE_CALL,
+        MULTI_DRAW_ELEMENTS_CALL,
+        MULTI_DRAW_ELEMENTS_BASE_VERTEX_CALL,
+        POLYGON_MODE_CALL,
+        PROGRAM_BINARY_CALL,
+        PROGRAM_PARAMETERI_CALL,
+        PROGRAM_UNIFORM1F_CALL,
+        PROGRAM_UNIFORM1I_CALL,
+        PROGRAM_UNIFORM2F_CALL,
+        PROGRAM_UNIFORM_MATRIX4FV_CALL,
+        SHADER_SOURCE_CALL,
+        TEX_BUFFER_CALL,
+        UNIFORM1F_CALL,
+        UNIFORM1I_CALL,
+        UNIFORM2F_CALL,
+        UNIFORM_BLOCK_BINDING_CALL,
+        UNIFORM_MATRIX4FV_CALL,
+        UNMAP_BUFFER_CALL,
+        USE_PROGRAM_CALL,
+        VERTEX_ATTRIB_DIVISOR_CALL,
+        VERTEX_ATTRIB_POINTER_CALL,
+        VIEWPORT_CALL,
+        CALL_COUNT,
+    };
+
+    /**
+     * @brief A uniform declared in a recorded shader, outside of a block
+     */
+    struct RecordedUniform
+    {
+        /**
+         * @brief The name, `name[0]` for an array, as glGetActiveUniform returns it
+         */
+        std::string name;
+        GLenum type;
+        GLint size;
+    };
+
+    /**
+     * @brief A backend which needs no context: every call is appended to a binary command stream
+     * One byte of opcode, then the scalar arguments as they are in memory. Pointed data is not
+     * copied, only its size: the bytes sent by glBufferData / glBufferSubData, or staged and
+     * copied with glCopyBufferSubData, are counted instead.
+     * Object names are allocated from 1, uniform locations are stable per name, compilations
+     * and links always succeed. Mapping a buffer returns host memory of the size it was given.
+     * A program reports the uniforms and blocks declared by the sources of its shaders, as
+     * the preprocessor conditions leave them, all active: see `RecordedUniform`.
+     */
+    struct Recorder
+    {
+        /**
+         * @brief The command stream
+         */
+        std::vector<uint8_t> stream;
+
+        /**
+         * @brief The number of calls, by entry point
+         */
+        std::size_t calls[CALL_COUNT] = {};
+
+        /**
+         * @brief The bytes uploaded into buffers
+         */
+        std::size_t uploadedBytes = 0;
+
+        /**
+         * @brief The next object name, and the location given to each uniform name
+         */
+        GLuint nextName = 1;
+        std::unordered_map<std::string, GLint> locations;
+
+        /**
+         * @brief The buffer bound to each target, and the memory returned when a buffer is mapped
+         */
+        std::unordered_map<GLenum, GLuint> bindings;
+        std::unordered_map<GLuint, std::vector<uint8_t>> storage;
+
+        /**
+         * @brief The uniforms declared by each shader, then by each linked program, and the
+         * uniform blocks likewise. The shaders attached to each program, until it is linked.
+         */
+        std::unordered_map<GLuint, std::vector<RecordedUniform>> uniforms;
+        std::unordered_map<GLuint, std::vector<std::string>> uniformBlocks;
+        std::unordered_map<GLuint, std::vector<GLuint>> attached;
+
+        /**
+         * @brief Returns the number of calls recorded
+         */
+        std::size_t totalCalls() const;
+
+        /**
+         * @brief Empties the stream and the counters, e.g. between two frames. The names and
+         * locations given so far stay valid.
+         */
+        void clear();
+    };
+
+    /**
+     * @brief Returns the current dispatch table, the driver's until `setDispatch` or `record`
+     */
+    const Dispatch &gl();
+
+    /**
+     * @brief Replaces the current dispatch table
+     */
+    void setDispatch(const Dispatch &dispatch);
+
+    /**
+     * @brief Returns the table calling the driver
+     */
+    const Dispatch &nativeDispatch();
+
+    /**
+     * @brief Sends every call to a recorder, until `setDispatch(nativeDispatch())`
+     *
+     * @param recorder - the recorder, which must outlive the recording
+     */
+    void record(Recorder &recorder);
+
+    /**
+     * @brief A function pointer as returned by glfwGetProcAddress or eglGetProcAddress
+     */
+    typedef void (*ProcAddress)(void);
+
+    /**
+     * @brief Returns whether the current context has a feature, core since a version or
+     * exposed as an extension. The entry point alone doesn't tell: drivers return one for
+     * functions they don't support. Needs a current context.
+     *
+     * @param major - the major version the feature is core in
+     * @param minor - the minor version the feature is core in
+     * @param extension - the name of the extension, e.g. "GL_ARB_buffer_storage"
+     */
+    bool supports(int major, int minor, const char *extension);
+
+    /**
+     * @brief Returns whether the current context exposes an extension, for the ones which
+     * are not core in any version, see `supports`
+     *
+     * @param extension - the name of the extension, e.g. "GL_KHR_parallel_shader_compile"
+     */
+    bool hasExtension(const char *extension);
+
+    /**
+     * @brief Resolves the entry points the driver may not have, which are null until then:
+     * BufferStorage (GL 4.4 or ARB_buffer_storage). Needs a current context.
+     *
+     * @param getProcAddress - the loader of the window system, e.g. glfwGetProcAddress
+     * @return Whether BufferStorage is available
+     */
+    bool loadExtensions(ProcAddress (*getProcAddress)(const char *));
+
+    /**
+     * @brief Returns the GL name of an entry point, e.g. "glDrawArrays"
+     */
+    const char *callName(Call call);
+}
+
+#endif /* _GL_DISPATCH_H */
@@ -0,0 +1,141 @@
+#ifndef _HEADLESS_H
+#define _HEADLESS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+
+/* Only pointers to the window here: the sources calling GLFW include it */
+struct GLFWwindow;
+
+namespace GLUtils
+{
+
+    /**
+     * @brief Returns the number of frames asked with `--headless N` on the command line
+     *
+     * @param argc - the number of arguments of main
+     * @param argv - the arguments of main
+     * @return The number of frames, 0 to open a window
+     */
+    std::size_t headlessFrames(int argc, char **argv);
+
+    /**
+     * @brief Initializes GLFW without a display (GLFW 3.4 null platform), instead of glfwInit
+     *
+     * @return false if GLFW could not be initialized
+     */
+    bool initHeadless();
+
+    /**
+     * @brief Creates a hidden window whose context renders without a display: EGL surfaceless
+     * (e.g. Mesa llvmpipe on a GPU-less machine), otherwise OSMesa. The context hints given
+     * before are kept, and the context is made current. Draw into an OffscreenTarget: the
+     * window has no default framebuffer to speak of.
+     *
+     * @param width - the width of the window, as returned by glfwGetFramebufferSize
+     * @param height - the height of the window
+     * @param title - the title of the window
+     * @return The window, or NULL if no context could be created
+     */
+    GLFWwindow *createHeadlessWindow(int width, int height, const char *title);
+
+    /**
+     * @brief A framebuffer with a RGBA8 color renderbuffer, to render without a window
+     */
+    struct OffscreenTarget
+    {
+
+    private:
+        GLuint framebuffer = 0;
+        GLuint color = 0;
+        int width;
+        int height;
+
+    public:
+        /**
+         * @brief Creates the framebuffer, the context must be current
+         *
+         * @param width - the width, in pixels
+         * @param height - the height, in pixels
+         */
+        OffscreenTarget(int width, int height);
+
+        /**
+         * @brief Destructor, deletes the framebuffer and its renderbuffer
+         */
+        ~OffscreenTarget();
+
+        OffscreenTarget(const OffscreenTarget &) = delete;
+        OffscreenTarget &operator=(const OffscreenTarget &) = delete;
+
+        /**
+         * @brief Returns whether the framebuffer is complete
+         */
+        bool isComplete() const;
+
+        /**
+         * @brief Binds the framebuffer as the draw and read framebuffer
+         */
+        void bind() const;
+
+        /**
+         * @brief Reads the pixels back, e.g. to compare two runs: waits for the rendering
+         *
+         * @param pixels - the RGBA8 pixels, bottom row first, overwritten
+         */
+        void read(std::vector<uint8_t> &pixels) const;
+
+        /**
+         * @brief Returns the FNV-1a hash of the pixels, see `read`
+         */
+        uint32_t checksum() const;
+    };
+
+    /**
+     * @brief The duration of each frame, for throughput and frame-time reports
+     * In headless mode, call glFinish before `end`: the GPU time is then part of the frame.
+     */
+    struct FrameTimes
+    {
+
+    private:
+        std::chrono::steady_clock::time_point start;
+        std::vector<double> frames;
+
+    public:
+        /**
+         * @brief Starts a frame
+         */
+        void begin();
+
+        /**
+         * @brief Ends the frame started by `begin`
+         */
+        void end();
+
+        /**
+         * @brief Returns the number of frames timed
+         */
+        std::size_t getCount() const;
+
+        /**
+         * @brief Logs the frames per second, and the mean, median, 99th percentile and
+         * longest frame times
+         *
+         * @param name - the name of the run
+         */
+        void report(const char *name) const;
+    };
+}
+
+#endif /* _HEADLESS_H */
@@ -0,0 +1,68 @@
+#ifndef _LINE_BATCH_H
+#define _LINE_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Base/line_utils.h"
+#include "Base/thread_pool.h"
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief The default number of points tessellated by a single task
+     */
+    const std::size_t BATCH_CHUNK_POINTS = 16384;
+
+    /**
+     * @brief A polyline to tessellate, the points are not copied
+     */
+    struct PolylineView
+    {
+        const glm::vec3 *points;
+        std::size_t count;
+    };
+
+    /**
+     * @brief Where a polyline landed in the batch buffers
+     */
+    struct BatchRange
+    {
+        std::size_t firstVertex;
+        std::size_t vertexCount;
+        std::size_t firstIndex;
+        std::size_t indexCount;
+    };
+
+    /**
+     * @brief The shared output of `tessellateBatch`: one vertex buffer, one index buffer
+     * Reusing the same Batch from one call to the next avoids reallocating the buffers.
+     */
+    struct Batch
+    {
+        std::vector<LineVertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<BatchRange> ranges;
+    };
+
+    /**
+     * @brief Tessellates many polylines at once, on the threads of `pool`
+     * The offset of each polyline in the shared buffers comes from a prefix sum of the vertex
+     * and index counts, so every task writes a disjoint range. Small polylines are grouped and
+     * long ones are cut into chunks of about `chunkPoints` points, one task each. A first pass
+     * measures the arc length of each chunk, so the distances continue from one chunk to the next.
+     * The indices are the triangles of MathsUtils::createIndices, offset by the first vertex
+     * of their polyline.
+     *
+     * @param polylines - the polylines to tessellate
+     * @param count - the number of polylines
+     * @param pool - the threads running the tasks, `tessellateBatch` waits for them
+     * @param batch - the output buffers, resized to fit
+     * @param chunkPoints - the number of points handled by one task
+     */
+    void tessellateBatch(const PolylineView *polylines, std::size_t count, ThreadUtils::ThreadPool &pool, Batch &batch, std::size_t chunkPoints = BATCH_CHUNK_POINTS);
+}
+
+#endif /* _LINE_BATCH_H */
@@ -0,0 +1,79 @@
+#ifndef _LINE_CHUNKS_H
+#define _LINE_CHUNKS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Base/maths_utils.h"
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief The default number of segments grouped in a chunk
+     */
+    const std::size_t LINE_CHUNK_SEGMENTS = 256;
+
+    /**
+     * @brief Consecutive segments of a polyline, and their bounding box
+     */
+    struct LineChunk
+    {
+        std::size_t firstSegment;
+        std::size_t segmentCount;
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+
+        /**
+         * @brief The indices of the segments, [firstIndex, firstIndex + indexCount)
+         */
+        std::size_t firstIndex;
+        std::size_t indexCount;
+    };
+
+    /**
+     * @brief A polyline cut in chunks, to only draw the ones inside the view frustum
+     * By default the chunks index the triangles of MathsUtils::createIndices / createIndices32:
+     * segment j owns the indices [6 * j, 6 * j + 6). Other layouts, e.g. StyledLine, give the
+     * first index of each segment.
+     */
+    struct ChunkedLine
+    {
+
+    private:
+        std::vector<LineChunk> chunks;
+
+    public:
+        /**
+         * @brief Cuts the polyline in chunks and computes their bounding boxes
+         *
+         * @param points - the contiguous points of the polyline
+         * @param count - the number of points
+         * @param chunkSegments - the number of segments per chunk
+         * @param segmentIndices - the first index of each segment then the index count,
+         * `count` values, or NULL for 6 indices per segment
+         */
+        void build(const glm::vec3 *points, std::size_t count, std::size_t chunkSegments = LINE_CHUNK_SEGMENTS, const uint32_t *segmentIndices = NULL);
+
+        /**
+         * @brief Lists the index ranges of the visible chunks, for glMultiDrawElements
+         * Consecutive visible chunks are merged in a single range.
+         *
+         * @param projViewModel - projection * view * model
+         * @param margin - the largest offset added by the vertex shader, in clip-space units
+         * @param indexType - GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+         * @param counts - the number of indices of each range, overwritten
+         * @param offsets - the byte offset of each range in the index buffer, overwritten
+         * @return The number of ranges to draw
+         */
+        GLsizei cull(const glm::mat4 &projViewModel, float margin, GLenum indexType, std::vector<GLsizei> &counts, std::vector<const void *> &offsets) const;
+
+        /**
+         * @brief Returns the chunks
+         */
+        const std::vector<LineChunk> &getChunks() const;
+    };
+}
+
+#endif /* _LINE_CHUNKS_H */
@@ -0,0 +1,76 @@
+#ifndef _LINE_EXTRUDE_H
+#define _LINE_EXTRUDE_H
+
+#include <cstddef>
+#include "Base/line_utils.h"
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief Maximum absolute difference, in clip-space units, between `extrude` and the attribute
+     * vertex shader running on a GPU.
+     * The SIMD lanes repeat the operations of `extrudeReference` in the same order, so both CPU
+     * paths agree bit for bit unless the compiler contracts them into FMAs. The GPU rounds its
+     * divisions and square roots differently: the bound holds for vertices inside the view volume,
+     * with screen-space segments longer than 1e-3 and a miter shorter than 100 times the thickness.
+     */
+    const float EXTRUDE_TOLERANCE = 1e-4f;
+
+    /**
+     * @brief The uniforms of the attribute vertex shader
+     */
+    struct ExtrudeParams
+    {
+        /**
+         * @brief projection * view * model
+         */
+        glm::mat4 projViewModel = glm::mat4(1.0f);
+
+        /**
+         * @brief The viewport width divided by its height
+         */
+        float aspect = 1.0f;
+
+        /**
+         * @brief The line thickness, in aspect-corrected normalized device coordinates
+         */
+        float thickness = 0.1f;
+
+        /**
+         * @brief Join the segments with a miter (the `miter` uniform set to 1)
+         */
+        bool miter = true;
+    };
+
+    /**
+     * @brief Runs the attribute vertex shader on the CPU, 4 or 8 vertices at a time
+     * Uses AVX2, SSE or NEON according to GLM_ARCH, and falls back to `extrudeReference` for the
+     * remaining vertices. Like the shader, the offset is added with a w of 1.
+     * Combined with MathsUtils::createIndices, `out` describes the final triangles of the line.
+     *
+     * @param vertices - the expanded polyline, see LineUtils::expand
+     * @param count - the number of vertices
+     * @param params - the shader uniforms
+     * @param out - the clip-space positions (gl_Position), `count` elements
+     */
+    void extrude(const LineVertex *vertices, std::size_t count, const ExtrudeParams &params, glm::vec4 *out);
+
+    /**
+     * @brief Scalar version of `extrude`, a line by line translation of the vertex shader
+     *
+     * @param vertices - the expanded polyline, see LineUtils::expand
+     * @param count - the number of vertices
+     * @param params - the shader uniforms
+     * @param out - the clip-space positions (gl_Position), `count` elements
+     */
+    void extrudeReference(const LineVertex *vertices, std::size_t count, const ExtrudeParams &params, glm::vec4 *out);
+
+    /**
+     * @brief Returns the instruction set used by `extrude`: "avx2", "sse", "neon" or "scalar"
+     */
+    const char *extrudeArch();
+}
+
+#endif /* _LINE_EXTRUDE_H */
@@ -0,0 +1,102 @@
+#ifndef _LINE_LOD_H
+#define _LINE_LOD_H
+
+#include <cstddef>
+#include <vector>
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief The number of points simplified together, see `simplificationErrors`
+     */
+    const std::size_t LOD_SPAN_POINTS = 4096;
+
+    /**
+     * @brief Returns the Douglas-Peucker significance of each point of a polyline
+     * A point is kept by Douglas-Peucker for any tolerance below its significance, the distance
+     * to the segment which replaces it. The significance never exceeds the one of the point
+     * splitting the parent segment, so the simplifications are nested. Both ends, and one point
+     * every LOD_SPAN_POINTS, are kept whatever the tolerance: this bounds the cost of the
+     * simplification, quadratic in the worst case.
+     *
+     * @param points - the contiguous points of the polyline
+     * @param count - the number of points
+     * @return The significance of each point, in model units
+     */
+    std::vector<float> simplificationErrors(const glm::vec3 *points, std::size_t count);
+
+    /**
+     * @brief One simplification of a polyline
+     */
+    struct LodLevel
+    {
+        /**
+         * @brief The Douglas-Peucker tolerance of the level: no point of the polyline is farther
+         * than this from the simplified one, in model units
+         */
+        float error;
+
+        /**
+         * @brief The points kept by the level
+         */
+        std::vector<glm::vec3> points;
+    };
+
+    /**
+     * @brief Simplifications of a polyline, precomputed once, from which the renderer picks
+     * the coarsest one whose projected error stays under a pixel threshold
+     */
+    struct LodHierarchy
+    {
+
+    private:
+        /**
+         * @brief The levels, from the full polyline (0) to the coarsest one
+         */
+        std::vector<LodLevel> levels;
+
+        /**
+         * @brief The bounding box of the polyline, to estimate its scale on screen
+         */
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+
+    public:
+        /**
+         * @brief Builds the levels, halving the tolerance from the size of the polyline
+         * down to the smallest significance. Levels which keep as many points as the
+         * next finer one are dropped.
+         *
+         * @param points - the contiguous points of the polyline
+         * @param count - the number of points
+         * @param maxLevels - the largest number of levels, the full polyline included
+         */
+        void build(const glm::vec3 *points, std::size_t count, std::size_t maxLevels = 24);
+
+        /**
+         * @brief Returns the coarsest level whose error, projected on screen, stays under
+         * `maxPixelError`. The scale is measured at the corners of the bounding box; if one of
+         * them is behind the camera, the full polyline is returned.
+         *
+         * @param projViewModel - projection * view * model
+         * @param viewport - the viewport size, in pixels
+         * @param maxPixelError - the largest error allowed, in pixels
+         * @return The index of the level
+         */
+        std::size_t selectLevel(const glm::mat4 &projViewModel, const glm::vec2 &viewport, float maxPixelError) const;
+
+        /**
+         * @brief Returns a level, 0 being the full polyline
+         */
+        const LodLevel &getLevel(std::size_t level) const;
+
+        /**
+         * @brief Returns the number of levels
+         */
+        std::size_t getLevelCount() const;
+    };
+}
+
+#endif /* _LINE_LOD_H */
@@ -0,0 +1,127 @@
+#ifndef _LINE_PAGES_H
+#define _LINE_PAGES_H
+
+#include <cstddef>
+#include <vector>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief The number of points in a page, the size of the `vertex` array of the uniformblock
+     * vertex shader. 1024 vec4 are 16KB, the smallest GL_MAX_UNIFORM_BLOCK_SIZE allowed.
+     */
+    const std::size_t LINE_PAGE_VERTICES = 1024;
+
+    /**
+     * @brief One draw call of a polyline stored in a page
+     */
+    struct PageDraw
+    {
+        /**
+         * @brief The page to bind
+         */
+        std::size_t page;
+
+        /**
+         * @brief The first point in the page, the `u_offset` uniform
+         */
+        GLint offset;
+
+        /**
+         * @brief The vertex count of glDrawArrays(GL_TRIANGLES, 0, vertexCount)
+         */
+        GLsizei vertexCount;
+    };
+
+    /**
+     * @brief Packs many polylines into fixed-size pages of a single uniform buffer, for the
+     * gl_VertexID line renderer. A polyline starts and ends with an adjacency-only point, like
+     * the BlockRect arrays: n points give n - 3 segments. Polylines longer than a page are split,
+     * the pieces overlapping by 3 points.
+     */
+    struct LinePages
+    {
+
+    private:
+        /**
+         * @brief The points of all the pages, LINE_PAGE_VERTICES per page
+         */
+        std::vector<glm::vec4> points;
+
+        /**
+         * @brief The draw calls of each polyline
+         */
+        std::vector<std::vector<PageDraw>> draws;
+
+        /**
+         * @brief The first free point in the last page
+         */
+        std::size_t used = LINE_PAGE_VERTICES;
+
+        /**
+         * @brief The uniform buffer ID and the distance between two pages in it, in bytes
+         */
+        GLuint buffer = 0;
+        GLintptr pageStride = 0;
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        LinePages();
+
+        /**
+         * @brief Destructor, deletes the uniform buffer
+         */
+        ~LinePages();
+
+        LinePages(const LinePages &) = delete;
+        LinePages &operator=(const LinePages &) = delete;
+
+        /**
+         * @brief Stores a polyline in the pages
+         *
+         * @param linePoints - the points, adjacency ones included. Their w is replaced by the arc
+         * length from the first point, read by the dash pattern of the fragment shader.
+         * @param count - the number of points, at least 4 to draw something
+         * @return The ID of the polyline, for `getDraws`
+         */
+        std::size_t add(const glm::vec4 *linePoints, std::size_t count);
+
+        /**
+         * @brief Creates the uniform buffer and sends all the pages, each one aligned on
+         * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT. Leaves GL_UNIFORM_BUFFER unbound.
+         */
+        void upload();
+
+        /**
+         * @brief Binds a page to a uniform buffer binding point, with glBindBufferRange
+         *
+         * @param page - the page
+         * @param binding - the binding point of the BlockRect block
+         */
+        void bindPage(std::size_t page, GLuint binding) const;
+
+        /**
+         * @brief Returns the draw calls of a polyline, ordered by page
+         */
+        const std::vector<PageDraw> &getDraws(std::size_t line) const;
+
+        /**
+         * @brief Returns the number of pages
+         */
+        std::size_t getPageCount() const;
+    };
+}
+
+#endif /* _LINE_PAGES_H */
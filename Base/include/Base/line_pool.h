@@ -0,0 +1,182 @@
+#ifndef _LINE_POOL_H
+#define _LINE_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+#include "Base/line_utils.h"
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief The arguments of glMultiDrawElementsBaseVertex, one element per line
+     */
+    struct PoolDrawList
+    {
+        std::vector<GLsizei> counts;
+        std::vector<const void *> offsets;
+        std::vector<GLint> baseVertices;
+
+        /**
+         * @brief Empties the list, keeping its memory
+         */
+        void clear();
+
+        /**
+         * @brief Returns the number of draws
+         */
+        GLsizei size() const;
+    };
+
+    /**
+     * @brief Many tessellated polylines in one vertex buffer and one index buffer
+     * Each line is suballocated a range of vertices and a range of indices (first fit). Its
+     * indices stay relative to its first vertex, given as the base vertex of its draw: lines
+     * are added and removed without touching the others. The whole set is then drawn with
+     * one VAO and one glMultiDrawElementsBaseVertex.
+     * The indices are 32-bit (GL_UNSIGNED_INT), the vertices are LineVertex.
+     */
+    struct LinePool
+    {
+
+    private:
+        /**
+         * @brief The elements [first, first + count) of a buffer
+         */
+        struct Range
+        {
+            std::size_t first;
+            std::size_t count;
+        };
+
+        /**
+         * @brief The ranges of a line; removed lines leave their slot to the next one added
+         */
+        struct Slot
+        {
+            Range vertices;
+            Range indices;
+            bool live;
+        };
+
+        /**
+         * @brief The content of the buffers, the free ranges sorted by position
+         */
+        std::vector<LineVertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<Range> freeVertices;
+        std::vector<Range> freeIndices;
+
+        std::vector<Slot> lines;
+        std::vector<std::size_t> freeSlots;
+
+        /**
+         * @brief The vertex and index buffer IDs, created by the first upload, and the
+         * number of elements allocated in them
+         */
+        GLuint vertexBuffer = 0;
+        GLuint indexBuffer = 0;
+        std::size_t vertexCapacity = 0;
+        std::size_t indexCapacity = 0;
+
+        /**
+         * @brief The elements [begin, end) modified since the last upload
+         */
+        std::size_t dirtyVertexBegin = 0;
+        std::size_t dirtyVertexEnd = 0;
+        std::size_t dirtyIndexBegin = 0;
+        std::size_t dirtyIndexEnd = 0;
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        LinePool();
+
+        /**
+         * @brief Destructor, deletes the GPU buffers
+         */
+        ~LinePool();
+
+        LinePool(const LinePool &) = delete;
+        LinePool &operator=(const LinePool &) = delete;
+
+        /**
+         * @brief Adds a tessellated line, e.g. a StyledLine
+         *
+         * @param lineVertices - the vertices of the line
+         * @param vertexCount - the number of vertices
+         * @param lineIndices - the triangles of the line, indexing `lineVertices`
+         * @param indexCount - the number of indices
+         * @return The ID of the line
+         */
+        std::size_t add(const LineVertex *lineVertices, std::size_t vertexCount, const uint32_t *lineIndices, std::size_t indexCount);
+
+        /**
+         * @brief Adds a polyline, expanded with `expand`: two triangles per segment
+         *
+         * @param points - the contiguous points of the polyline
+         * @param count - the number of points
+         * @return The ID of the line
+         */
+        std::size_t addPolyline(const glm::vec3 *points, std::size_t count);
+
+        /**
+         * @brief Removes a line, its ranges are reused by the next lines added
+         *
+         * @param line - the ID of the line
+         */
+        void remove(std::size_t line);
+
+        /**
+         * @brief Sends the modified vertices and indices to the GPU
+         * The buffers grow geometrically: when they do, everything is sent again, under
+         * the same buffer IDs. Buffers are left unbound.
+         *
+         * @return The number of bytes uploaded
+         */
+        std::size_t upload();
+
+        /**
+         * @brief Appends the draw of a line to a list
+         *
+         * @param line - the ID of the line
+         * @param list - the list to append to
+         */
+        void appendDraw(std::size_t line, PoolDrawList &list) const;
+
+        /**
+         * @brief Lists the draws of all the lines
+         *
+         * @param list - the list, overwritten
+         */
+        void drawAll(PoolDrawList &list) const;
+
+        /**
+         * @brief Returns the vertex buffer ID, stable once the first upload is done
+         */
+        GLuint getVertexBuffer() const;
+
+        /**
+         * @brief Returns the index buffer ID, stable once the first upload is done
+         */
+        GLuint getIndexBuffer() const;
+
+        /**
+         * @brief Returns the number of lines in the pool
+         */
+        std::size_t getLineCount() const;
+    };
+}
+
+#endif /* _LINE_POOL_H */
@@ -0,0 +1,141 @@
+#ifndef _LINE_QUANTIZE_H
+#define _LINE_QUANTIZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Base/line_utils.h"
+#include "Base/line_chunks.h"
+#include "Base/line_pool.h"
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief How the components of a CompactLineVertex are stored
+     */
+    enum QuantizedFormat
+    {
+        /**
+         * @brief 16-bit signed normalized integers, GL_SHORT with `normalized` set
+         */
+        SNORM16_FORMAT,
+
+        /**
+         * @brief 16-bit floats, GL_HALF_FLOAT
+         */
+        HALF_FORMAT,
+    };
+
+    /**
+     * @brief One vertex of a quantized polyline, 4 components of 16 bits, see `quantize`:
+     * the position in the bounding box of its chunk, mapped to [-1, 1], then
+     * direction * (0.5 + 0.5 * t), t the arc length in the chunk mapped to [0, 1].
+     * The direction is the sign of the last component, which is never 0.
+     */
+    struct CompactLineVertex
+    {
+        uint64_t packed;
+    };
+
+    static_assert(sizeof(CompactLineVertex) == 4 * sizeof(uint16_t), "CompactLineVertex must stay tightly packed");
+
+    /**
+     * @brief The texels of a chunk in the table of `packChunks`: the 4 columns of its
+     * dequantization, then its distance start and length
+     */
+    const std::size_t QUANTIZED_CHUNK_TEXELS = 5;
+
+    /**
+     * @brief A chunk of a quantized polyline, one draw of glMultiDrawElementsBaseVertex
+     */
+    struct QuantizedChunk
+    {
+        std::size_t firstSegment;
+        std::size_t segmentCount;
+
+        /**
+         * @brief The base vertex of the draw: the chunk starts with the padding of `expandAliased`
+         */
+        std::size_t firstVertex;
+
+        /**
+         * @brief Maps the quantized positions back to the polyline space: multiplies the model matrix
+         */
+        glm::mat4 dequantize;
+
+        /**
+         * @brief The arc length of the first point of the chunk, and the one it adds
+         */
+        float distanceStart;
+        float distanceLength;
+
+        /**
+         * @brief The largest distance between a point and its dequantized position, and the
+         * largest error on the arc length
+         */
+        float positionError;
+        float distanceError;
+    };
+
+    /**
+     * @brief A polyline quantized chunk by chunk, see `quantize`
+     */
+    struct QuantizedLine
+    {
+        QuantizedFormat format = SNORM16_FORMAT;
+        std::vector<CompactLineVertex> vertices;
+
+        /**
+         * @brief The triangles of the longest chunk, indexing its vertices: every chunk draws
+         * the first 6 * segmentCount of them with its first vertex as base vertex
+         */
+        std::vector<uint16_t> indices;
+
+        std::vector<QuantizedChunk> chunks;
+
+        /**
+         * @brief The vertices of every chunk but the last, which may have fewer: vertex v
+         * belongs to chunk v / chunkVertices. gl_VertexID includes the base vertex, so the
+         * shader finds the chunk of its vertex without knowing the draw.
+         */
+        std::size_t chunkVertices = 0;
+    };
+
+    /**
+     * @brief Quantizes a polyline in chunks of segments for the compact shader, with 8 bytes per
+     * vertex instead of the 44 of LineVertex. Each chunk is stored as an `expandAliased` buffer
+     * of its own, quantized against its bounding box: its padding holds the points around the
+     * chunk, so that the joins don't change across chunks. The previous and next attributes
+     * alias the position as for AliasedLineVertex.
+     *
+     * @param points - the contiguous points of the polyline
+     * @param count - the number of points
+     * @param format - how the components are stored
+     * @param chunkSegments - the number of segments per chunk, e.g. LINE_CHUNK_SEGMENTS, capped
+     * for 16-bit indices
+     * @param out - the quantized polyline, overwritten
+     */
+    void quantize(const glm::vec3 *points, std::size_t count, QuantizedFormat format, std::size_t chunkSegments, QuantizedLine &out);
+
+    /**
+     * @brief Packs what the chunks of a quantized polyline are drawn with, for the compact
+     * shader to read from a GL_RGBA32F texture buffer: QUANTIZED_CHUNK_TEXELS per chunk
+     *
+     * @param line - the quantized polyline
+     * @param texels - the table, overwritten
+     */
+    void packChunks(const QuantizedLine &line, std::vector<glm::vec4> &texels);
+
+    /**
+     * @brief Lists the draws of the chunks of a quantized polyline, all drawn with one
+     * glMultiDrawElementsBaseVertex of 16-bit indices
+     *
+     * @param line - the quantized polyline
+     * @param list - the list, overwritten
+     */
+    void drawChunks(const QuantizedLine &line, PoolDrawList &list);
+}
+
+#endif /* _LINE_QUANTIZE_H */
@@ -0,0 +1,91 @@
+#ifndef _LINE_STYLE_H
+#define _LINE_STYLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Base/line_utils.h"
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief How two consecutive segments are joined
+     */
+    enum JoinStyle
+    {
+        MITER_JOIN,
+        BEVEL_JOIN,
+        ROUND_JOIN,
+    };
+
+    /**
+     * @brief How the ends of a polyline are drawn
+     */
+    enum CapStyle
+    {
+        BUTT_CAP,
+        SQUARE_CAP,
+        ROUND_CAP,
+    };
+
+    /**
+     * @brief The joins and caps of a tessellated polyline
+     */
+    struct LineStyle
+    {
+        JoinStyle join = MITER_JOIN;
+        CapStyle cap = BUTT_CAP;
+
+        /**
+         * @brief The longest miter, in line widths: sharper turns are beveled
+         */
+        float miterLimit = 4.0f;
+
+        /**
+         * @brief The number of triangles of a half turn, for round joins and caps.
+         * Bevel and round joins turning by less than one step are mitered instead.
+         */
+        unsigned int roundSegments = 8;
+
+        /**
+         * @brief The normal of the plane in which the caps and round joins are built, when the
+         * polyline doesn't define one. They are exact when this plane faces the camera.
+         */
+        glm::vec3 up = glm::vec3(0.0f, 0.0f, 1.0f);
+    };
+
+    /**
+     * @brief A tessellated polyline, drawn with glDrawElements(GL_TRIANGLES) by the attribute shader
+     */
+    struct StyledLine
+    {
+        std::vector<LineVertex> vertices;
+        std::vector<uint32_t> indices;
+
+        /**
+         * @brief The first index of each segment of the input polyline, then the index count:
+         * segment j owns the indices [segmentIndices[j], segmentIndices[j + 1]), its join with
+         * the next segment and the caps included. See ChunkedLine::build.
+         */
+        std::vector<uint32_t> segmentIndices;
+    };
+
+    /**
+     * @brief Tessellates a polyline with joins and caps, for the attribute shader with `miter` = 1
+     * Only the mitered joins use the shader's join branch: bevels, round joins and caps are extra
+     * triangles whose vertices have their previous (or next) point equal to their position, so
+     * the shader offsets them along a single direction. The miter limit is checked in model
+     * space, only to choose the joins: the shader bevels the miters still too long once
+     * projected. Repeated points are skipped.
+     *
+     * @param points - the contiguous points of the polyline
+     * @param count - the number of points
+     * @param style - the joins and caps
+     * @param out - the tessellated polyline, overwritten
+     */
+    void tessellate(const glm::vec3 *points, std::size_t count, const LineStyle &style, StyledLine &out);
+}
+
+#endif /* _LINE_STYLE_H */
@@ -0,0 +1,159 @@
+#ifndef _LINE_UTILS_H
+#define _LINE_UTILS_H
+
+#include <cstddef>
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief One expanded vertex of a polyline, interleaved in the order read by the attribute shader:
+     * position (location 0), direction (location 1), next (location 2), previous (location 3),
+     * distance (location 4), the arc length from the first point, for dash patterns
+     */
+    struct LineVertex
+    {
+        glm::vec3 position;
+        float direction;
+        glm::vec3 next;
+        glm::vec3 previous;
+        float distance;
+    };
+
+    static_assert(sizeof(LineVertex) == 11 * sizeof(float), "LineVertex must stay tightly packed");
+
+    /**
+     * @brief Returns the number of expanded vertices needed for a polyline
+     * Each point is emitted twice, once per side of the line.
+     *
+     * @param count - the number of points in the polyline
+     * @return The number of LineVertex to allocate for the expanded polyline
+     */
+    std::size_t expandedSize(std::size_t count);
+
+    /**
+     * @brief Expands a polyline into its interleaved vertex buffer, in a single pass
+     * Replaces the MathsUtils::duplicate / MathsUtils::relative chain: the previous and next
+     * neighbours are clamped to the path ends, the direction is -1 then 1 for each point, the
+     * distance is the prefix sum of the segment lengths.
+     * Nothing is allocated: `out` must hold at least `expandedSize(count)` vertices.
+     *
+     * @param points - the contiguous points of the polyline
+     * @param count - the number of points
+     * @param out - the destination buffer
+     */
+    void expand(const glm::vec3 *points, std::size_t count, LineVertex *out);
+
+    /**
+     * @brief Expands the points [first, last) of a polyline, see `expand`
+     * The neighbours are still read from, and clamped to, the whole polyline: chunks of a long
+     * polyline can be expanded independently and give the same result as a single `expand`,
+     * given the arc length of their first point.
+     *
+     * @param points - the contiguous points of the whole polyline
+     * @param count - the number of points of the whole polyline
+     * @param first - the first point to expand
+     * @param last - one past the last point to expand
+     * @param startDistance - the arc length of the point `first`
+     * @param out - the destination buffer, `expandedSize(last - first)` vertices
+     */
+    void expandRange(const glm::vec3 *points, std::size_t count, std::size_t first, std::size_t last, float startDistance, LineVertex *out);
+
+    /**
+     * @brief Returns the arc length between two points of a polyline
+     *
+     * @param points - the contiguous points of the polyline
+     * @param first - the first point
+     * @param last - the last point, included
+     * @return The sum of the lengths of the segments [first, last]
+     */
+    float arcLength(const glm::vec3 *points, std::size_t first, std::size_t last);
+
+    /**
+     * @brief The vertices of the quad drawn for each segment instance, as a triangle strip
+     */
+    const std::size_t SEGMENT_INSTANCE_VERTICES = 4;
+
+    /**
+     * @brief Returns the number of points of the buffer read by the segment instances
+     * The ends are repeated, so every segment has a previous and a next point.
+     *
+     * @param count - the number of points in the polyline
+     * @return The number of vec4 to allocate, see `expandInstanced`
+     */
+    std::size_t instancedSize(std::size_t count);
+
+    /**
+     * @brief Writes a polyline for instanced rendering: one instance per segment, instead of
+     * the two LineVertex of `expand` per point
+     * `out` holds the first point, then all the points, then the last point, with the arc length
+     * in w. Instance i reads `out[i]` to `out[i + 3]` (previous, start, end, next) through
+     * four attributes with a divisor of 1, and builds its quad from gl_VertexID: 4 floats per
+     * point instead of 22.
+     * Nothing is allocated: `out` must hold at least `instancedSize(count)` points.
+     *
+     * @param points - the contiguous points of the polyline
+     * @param count - the number of points
+     * @param out - the destination buffer
+     */
+    void expandInstanced(const glm::vec3 *points, std::size_t count, glm::vec4 *out);
+
+    /**
+     * @brief One vertex of a polyline whose neighbours are read from the same buffer, see
+     * `expandAliased`: position (location 0), direction (location 1), distance (location 4)
+     */
+    struct AliasedLineVertex
+    {
+        glm::vec3 position;
+        float direction;
+        float distance;
+    };
+
+    static_assert(sizeof(AliasedLineVertex) == 5 * sizeof(float), "AliasedLineVertex must stay tightly packed");
+
+    /**
+     * @brief The vertices added before and after the polyline, see `expandAliased`: the two
+     * vertices of a point, so that `previous` and `next` are one point away
+     */
+    const std::size_t ALIASED_LINE_PADDING = 2;
+
+    /**
+     * @brief Returns the number of aliased vertices needed for a polyline, padding included
+     *
+     * @param count - the number of points in the polyline
+     * @return The number of AliasedLineVertex to allocate, see `expandAliased`
+     */
+    std::size_t aliasedSize(std::size_t count);
+
+    /**
+     * @brief Expands a polyline into a buffer where `previous` and `next` alias `position`
+     * The two vertices of each point are padded by the two of the first point before, and the
+     * two of the last point after. The vertex v of the line, as indexed by the triangles of
+     * `expand`, is read at `ALIASED_LINE_PADDING + v`: `previous` is then the vertex
+     * ALIASED_LINE_PADDING before, `next` the one ALIASED_LINE_PADDING after, clamped to the
+     * ends by the padding. Three attribute pointers into the same buffer give the attribute
+     * shader the same inputs as `expand`, from 5 floats per vertex instead of 11.
+     * Nothing is allocated: `out` must hold at least `aliasedSize(count)` vertices.
+     *
+     * @param points - the contiguous points of the polyline
+     * @param count - the number of points
+     * @param out - the destination buffer
+     */
+    void expandAliased(const glm::vec3 *points, std::size_t count, AliasedLineVertex *out);
+
+    /**
+     * @brief Expands the points [first, last) of a polyline into its aliased buffer, see
+     * `expandAliased`, and the padding of the ends in the range
+     *
+     * @param points - the contiguous points of the whole polyline
+     * @param count - the number of points of the whole polyline
+     * @param first - the first point to expand
+     * @param last - one past the last point to expand
+     * @param startDistance - the arc length of the point `first`
+     * @param out - the aliased buffer of the whole polyline, `aliasedSize(count)` vertices
+     */
+    void expandAliasedRange(const glm::vec3 *points, std::size_t count, std::size_t first, std::size_t last, float startDistance, AliasedLineVertex *out);
+}
+
+#endif /* _LINE_UTILS_H */
@@ -0,0 +1,130 @@
+#ifndef _LIVE_POLYLINE_H
+#define _LIVE_POLYLINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+#include "Base/line_utils.h"
+#include "Base/upload_ring.h"
+#include "../../../glm/glm/glm.hpp"
+
+namespace LineUtils
+{
+
+    /**
+     * @brief A polyline which keeps changing, e.g. streamed telemetry
+     * Appending or editing points only tessellates the affected vertices again, and `upload`
+     * only sends the byte ranges which changed since the previous upload.
+     * The indices are 32-bit (GL_UNSIGNED_INT), the vertices are AliasedLineVertex: the
+     * previous and next attributes point into the vertex buffer too, see `expandAliased`.
+     */
+    struct LivePolyline
+    {
+
+    private:
+        std::vector<glm::vec3> points;
+        std::vector<AliasedLineVertex> vertices;
+        std::vector<uint32_t> indices;
+
+        /**
+         * @brief The vertex and index buffer IDs, created by the first upload
+         */
+        GLuint vertexBuffer = 0;
+        GLuint indexBuffer = 0;
+
+        /**
+         * @brief The number of elements allocated in the GPU buffers
+         */
+        std::size_t vertexCapacity = 0;
+        std::size_t indexCapacity = 0;
+
+        /**
+         * @brief The elements [begin, end) modified since the last upload
+         */
+        std::size_t dirtyVertexBegin = 0;
+        std::size_t dirtyVertexEnd = 0;
+        std::size_t dirtyIndexBegin = 0;
+        std::size_t dirtyIndexEnd = 0;
+
+        /**
+         * @brief Expands the points [first, last) again and marks their vertices as dirty,
+         * the points before `first` must be up to date
+         */
+        void retessellate(std::size_t first, std::size_t last);
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        LivePolyline();
+
+        /**
+         * @brief Destructor, deletes the GPU buffers
+         */
+        ~LivePolyline();
+
+        LivePolyline(const LivePolyline &) = delete;
+        LivePolyline &operator=(const LivePolyline &) = delete;
+
+        /**
+         * @brief Appends points at the end of the polyline
+         * Only the new points, and the padding after them, are tessellated.
+         *
+         * @param newPoints - the points to append
+         * @param count - the number of points
+         */
+        void append(const glm::vec3 *newPoints, std::size_t count);
+
+        /**
+         * @brief Moves a point of the polyline
+         * Its neighbours read it through the aliased attributes, but the arc length of the
+         * following points changes: their vertices are sent again by the next upload.
+         *
+         * @param index - the index of the point
+         * @param point - its new position
+         */
+        void edit(std::size_t index, const glm::vec3 &point);
+
+        /**
+         * @brief Sends the modified vertices and indices to the GPU
+         * The buffers grow geometrically: when they do, everything is sent again.
+         * Buffers are left unbound.
+         *
+         * @param staging - if given, the bytes are written into the frame of the ring and copied
+         * on the GPU, rather than sent with glBufferSubData; which is still used when the
+         * frame is full
+         * @return The number of bytes uploaded
+         */
+        std::size_t upload(GLUtils::UploadRing *staging = NULL);
+
+        /**
+         * @brief Returns the vertex buffer ID, stable once the first upload is done
+         */
+        GLuint getVertexBuffer() const;
+
+        /**
+         * @brief Returns the index buffer ID, stable once the first upload is done
+         */
+        GLuint getIndexBuffer() const;
+
+        /**
+         * @brief Returns the number of indices to draw
+         */
+        GLsizei getIndexCount() const;
+
+        /**
+         * @brief Returns the points of the polyline
+         */
+        const std::vector<glm::vec3> &getPoints() const;
+    };
+}
+
+#endif /* _LIVE_POLYLINE_H */
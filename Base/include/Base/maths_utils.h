@@ -2,6 +2,8 @@
 #define _MATHS_UTILS_H
 
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 #ifdef __APPLE__
 /* Defined before OpenGL and GLUT includes to avoid deprecation messages */
 #define GL_SILENCE_DEPRECATION
@@ -11,6 +13,7 @@
  #include <GL/gl.h>
 #include <GL/glut.h>
 #endif
+#include "../../../glm/glm/glm.hpp"
 
 namespace MathsUtils
 {
@@ -89,11 +92,94 @@ namespace MathsUtils
 
     std::vector<float> duplicate(std::vector<std::vector<float>> array, bool mirror);
 
-    std::vector<uint16_t> createIndices(int length);
+    /**
+     * @brief Returns the largest number of vertices addressable with 16-bit indices
+     */
+    const std::size_t MAX_UNSIGNED_SHORT_VERTICES = 65536;
+
+    /**
+     * @brief Writes the triangles of the segments of an expanded polyline, two per segment:
+     * the layout of every index buffer of the lines
+     *
+     * @param segments - the number of segments
+     * @param base - the vertex of the first point of the first segment
+     * @param indices - the segments * 6 indices, overwritten
+     */
+    template <typename Index>
+    void writeIndices(std::size_t segments, std::size_t base, Index *indices)
+    {
+        std::size_t c = 0, index = base;
+        for (std::size_t j = 0; j < segments; j++)
+        {
+            Index i = (Index)index;
+            indices[c++] = i + 0;
+            indices[c++] = i + 1;
+            indices[c++] = i + 2;
+            indices[c++] = i + 2;
+            indices[c++] = i + 1;
+            indices[c++] = i + 3;
+            index += 2;
+        }
+    }
+
+    /**
+     * @brief Creates the triangles of an expanded polyline, two per segment, as 16-bit indices
+     * Past MAX_UNSIGNED_SHORT_VERTICES / 2 points, the indices would wrap: none are created
+     * and an error is logged, use createIndices32 then (see `indexType`).
+     *
+     * @param length - the number of points of the polyline
+     * @return The (length - 1) * 6 indices, empty if they do not fit in 16 bits
+     */
+    std::vector<uint16_t> createIndices(std::size_t length);
+
+    /**
+     * @brief Creates the triangles of an expanded polyline, as 32-bit indices
+     *
+     * @param length - the number of points of the polyline
+     * @return The (length - 1) * 6 indices
+     */
+    std::vector<uint32_t> createIndices32(std::size_t length);
+
+    /**
+     * @brief Returns the smallest index type able to address the vertices in a single call
+     *
+     * @param vertexCount - the number of vertices, two per point of an expanded polyline
+     * @return GL_UNSIGNED_SHORT, or GL_UNSIGNED_INT past MAX_UNSIGNED_SHORT_VERTICES
+     */
+    GLenum indexType(std::size_t vertexCount);
 
     std::vector<std::vector<float>> relative(std::vector<std::vector<float>> array, int offset);
 
     int clamp(int value, int begin, int end);
+
+    /**
+     * @brief The six planes (a, b, c, d) of a view frustum, a point p is inside a plane when
+     * dot(a, b, c, p) + d >= 0. In order: left, right, bottom, top, near, far.
+     */
+    struct Frustum
+    {
+        glm::vec4 planes[6];
+    };
+
+    /**
+     * @brief Extracts the frustum of a projection * view * model matrix, in model space
+     *
+     * @param projViewModel - the matrix
+     * @param margin - how far, in clip-space units, the left / right / bottom / top planes are pushed
+     * outwards: vertex shaders offsetting the projected positions need it to not cull visible geometry
+     * @return The frustum
+     */
+    Frustum frustumFromMatrix(const glm::mat4 &projViewModel, float margin = 0.0f);
+
+    /**
+     * @brief Returns if an axis-aligned box is, at least partially, inside a frustum
+     * Conservative: a few boxes outside, near the frustum corners, are reported inside.
+     *
+     * @param frustum - the frustum
+     * @param boundsMin - the minimum corner of the box
+     * @param boundsMax - the maximum corner of the box
+     */
+    bool intersects(const Frustum &frustum, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
 }
 
 #endif
@@ -0,0 +1,166 @@
+#ifndef _SHADER_LOADER_H
+#define _SHADER_LOADER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ShaderUtils
+{
+
+    /**
+     * @brief A file embedded in the executable at build time, by the `embed_shaders` CMake
+     * function: its contents are followed by a null terminator, not included
+     */
+    struct EmbeddedFile
+    {
+        std::string_view name;
+        std::string_view contents;
+    };
+
+    /**
+     * @brief A read-only memory mapping of a whole file: the pages are read by the kernel on
+     * first access, without copy (POSIX mmap). Elsewhere, the file is read in one block.
+     */
+    struct MappedFile
+    {
+
+    private:
+        const char *data = nullptr;
+        std::size_t size = 0;
+
+    public:
+        /**
+         * @brief Constructor, maps nothing
+         */
+        MappedFile();
+
+        /**
+         * @brief Destructor, unmaps the file
+         */
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /**
+         * @brief Maps a file, unmapping the previous one
+         *
+         * @param path - the path of the file
+         * @return false if the file cannot be read, nothing is mapped then
+         */
+        bool open(const std::string &path);
+
+        /**
+         * @brief Unmaps the file, the views of `contents` are invalidated
+         */
+        void close();
+
+        /**
+         * @brief Returns the contents of the file, empty if nothing is mapped
+         */
+        std::string_view contents() const;
+    };
+
+    /**
+     * @brief Loads the shaders by name: from the files embedded in the executable, unless
+     * overridden by the file of the same name in the override directories, which is then
+     * mapped. Loading an embedded shader neither allocates nor reads a file.
+     */
+    struct ShaderLoader
+    {
+
+    private:
+        const EmbeddedFile *files;
+        std::size_t count;
+        std::vector<std::string> overrideDirectories;
+
+        /**
+         * @brief The names overridden, see `override`, and their mapped files
+         */
+        bool overridesAll = false;
+        std::vector<std::string> overridden;
+        std::unordered_map<std::string, std::unique_ptr<MappedFile>> mapped;
+
+        /**
+         * @brief Returns the embedded file of a name, nullptr if none
+         */
+        const EmbeddedFile *find(std::string_view name) const;
+
+        /**
+         * @brief Returns whether the override file of a name is preferred
+         */
+        bool isOverridden(std::string_view name) const;
+
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param files - the embedded files, which must outlive the loader
+         * @param count - the number of embedded files
+         * @param override_directory - the directory of the override files, none if empty
+         */
+        ShaderLoader(const EmbeddedFile *files, std::size_t count, const std::string &override_directory = "");
+
+        /**
+         * @brief Constructor, from the array generated by `embed_shaders`
+         */
+        template <std::size_t N>
+        ShaderLoader(const EmbeddedFile (&files)[N], const std::string &override_directory = "")
+            : ShaderLoader(files, N, override_directory)
+        {
+        }
+
+        /**
+         * @brief Adds a directory to look the override files up in, after the previous ones,
+         * e.g. the one of the shaders shared with other programs
+         */
+        void addOverrideDirectory(const std::string &directory);
+
+        /**
+         * @brief Loads a shader: its override file if it was overridden and exists, otherwise
+         * its embedded contents
+         *
+         * @param name - the name of the shader, relative to the override directories
+         * @param source - the contents, valid until this shader is overridden again (mapped)
+         * or for the whole run (embedded): overwritten
+         * @return false if the shader has no override file nor embedded contents (error is logged)
+         */
+        bool load(std::string_view name, std::string_view &source);
+
+        /**
+         * @brief Returns whether a shader can be loaded: embedded, or overridden by an existing file
+         */
+        bool contains(std::string_view name) const;
+
+        /**
+         * @brief Prefers the override file of a shader from now on, e.g. once it is saved:
+         * the embedded contents are used as long as the file is missing. The file is mapped
+         * again by the next `load`, the views of the previous mapping are invalidated.
+         */
+        void override(std::string_view name);
+
+        /**
+         * @brief Prefers the override files of all the shaders from now on, see `override`
+         */
+        void overrideAll();
+
+        /**
+         * @brief Returns the path of the override file of a shader, e.g. to watch it: in the
+         * first override directory holding it, otherwise in the first one
+         */
+        std::string getOverridePath(std::string_view name) const;
+
+        /**
+         * @brief Returns the name of a shader from the path of its override file
+         *
+         * @return The name, empty if the path is not in an override directory
+         */
+        std::string getName(const std::string &path) const;
+    };
+}
+
+#endif /* _SHADER_LOADER_H */
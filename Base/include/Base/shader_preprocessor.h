@@ -0,0 +1,180 @@
+#ifndef _SHADER_PREPROCESSOR_H
+#define _SHADER_PREPROCESSOR_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Base/shader_loader.h"
+#include "Base/shader_utils.h"
+
+namespace ShaderUtils
+{
+
+    /**
+     * @brief The macros injected into a shader, as (name, value) pairs: the value may be
+     * empty, e.g. {"LINE_MITER", ""}
+     */
+    typedef std::vector<std::pair<std::string, std::string>> Defines;
+
+    /**
+     * @brief The deepest `#include` nesting, deeper includes are reported as errors
+     */
+    const std::size_t MAX_INCLUDE_DEPTH = 16;
+
+    /**
+     * @brief Resolves the `#include "file"` directives of a shader and injects `#define`s
+     * after its `#version`. Includes are looked up next to the including file, then in the
+     * include directories; `#pragma once` includes a file once. `#line` directives keep the
+     * compilation errors at their line, the source string number being the index of the file
+     * in the list of files read. The files are read from the disk, or by name from a
+     * ShaderLoader, see `setLoader`.
+     */
+    struct Preprocessor
+    {
+
+    private:
+        std::vector<std::string> includeDirectories;
+        ShaderLoader *loader = nullptr;
+
+        /**
+         * @brief Appends a file and its includes to the output
+         */
+        bool expand(const std::string &path, std::size_t depth, std::string &output, std::vector<std::string> &files, std::vector<std::string> &included) const;
+
+    public:
+        /**
+         * @brief Adds a directory to look the includes up in, after the one of the including file
+         */
+        void addIncludeDirectory(const std::string &directory);
+
+        /**
+         * @brief Reads the shaders and their includes from a loader, e.g. the embedded ones:
+         * the paths are then the names of the loader
+         *
+         * @param shaders - the loader, which must outlive the preprocessor
+         */
+        void setLoader(ShaderLoader &shaders);
+
+        /**
+         * @brief Preprocesses a shader file
+         *
+         * @param path - the path of the shader, or its name with a loader
+         * @param defines - the macros to define, in this order
+         * @param output - the source to compile, overwritten
+         * @param files - the files read, the shader first then its includes: overwritten
+         * @return false if a file is missing or included recursively (error is logged)
+         */
+        bool process(const std::string &path, const Defines &defines, std::string &output, std::vector<std::string> &files) const;
+    };
+
+    /**
+     * @brief The programs compiled from shader files with sets of defines, the permutations of
+     * their features: e.g. the join of the lines compiled out rather than branched on a uniform.
+     * A permutation is compiled on its first use, and each stage once for all the permutations
+     * sharing it (see StageCache).
+     */
+    struct PermutationCache
+    {
+
+    private:
+        struct Permutation
+        {
+            std::string vertexPath;
+            std::string fragmentPath;
+            Defines vertexDefines;
+            Defines fragmentDefines;
+
+            /**
+             * @brief The files of both stages, includes included
+             */
+            std::vector<std::string> files;
+
+            /**
+             * @brief Set when the preprocessing failed, until `poll` reports it
+             */
+            bool failed = false;
+            Program program;
+        };
+
+        Preprocessor preprocessor;
+        std::string binaryDirectory;
+
+        /**
+         * @brief Declared before the programs, which release their stages to it
+         */
+        StageCache stages;
+        std::unordered_map<std::string, Permutation> permutations;
+
+        /**
+         * @brief Preprocesses the files of a permutation and submits its program
+         */
+        void submit(Permutation &permutation);
+
+    public:
+        /**
+         * @brief Returns the preprocessor, e.g. to add include directories
+         */
+        Preprocessor &getPreprocessor();
+
+        /**
+         * @brief Enables the program binary cache of the permutations, see Program::setBinaryCache
+         *
+         * @param directory - the cache directory
+         */
+        void setBinaryCache(const std::string &directory);
+
+        /**
+         * @brief Returns a permutation, submitted for compilation on its first use: it is
+         * registered once `poll` has swapped it in
+         *
+         * @param vertex_path - the path of the vertex shader, see Preprocessor::process
+         * @param fragment_path - the path of the fragment shader
+         * @param vertex_defines - the macros of the vertex shader, in any order
+         * @param fragment_defines - the macros of the fragment shader, in any order
+         * @return The program, which lives as long as the cache
+         */
+        Program &get(const std::string &vertex_path, const std::string &fragment_path, const Defines &vertex_defines = {}, const Defines &fragment_defines = {});
+
+        /**
+         * @brief Submits again the permutations which read a changed file
+         *
+         * @param changed - the files changed, e.g. by a FileWatcher: all the permutations if empty
+         * @return The number of permutations submitted
+         */
+        std::size_t reload(const std::vector<std::string> &changed = {});
+
+        /**
+         * @brief Swaps in the permutations linked since they were submitted, see Program::pollProgram
+         *
+         * @param wait - wait for the driver, see Program::finishProgram
+         * @return PROGRAM_READY if one was swapped in, otherwise PROGRAM_FAILED if one failed
+         * (error is logged), PROGRAM_PENDING if one is still compiling, PROGRAM_IDLE if none
+         * was submitted
+         */
+        ProgramStatus poll(bool wait);
+
+        /**
+         * @brief Returns the programs of the permutations, registered or not
+         */
+        std::vector<Program *> getPrograms();
+
+        /**
+         * @brief Returns the files read by the permutations, includes included, e.g. to watch them
+         */
+        std::vector<std::string> getFiles() const;
+
+        /**
+         * @brief Returns the stages shared by the permutations
+         */
+        const StageCache &getStageCache() const;
+
+        /**
+         * @brief Returns the number of permutations
+         */
+        std::size_t size() const;
+    };
+}
+
+#endif /* _SHADER_PREPROCESSOR_H */
@@ -1,17 +1,171 @@
 #ifndef _SHADER_UTILS_H
 #define _SHADER_UTILS_H
 
+#include <cstdint>
+#include <initializer_list>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+#include "../../../glm/glm/glm.hpp"
+#include "Base/gl_dispatch.h"
 
 namespace ShaderUtils
 {
 
+    /**
+     * @brief Hashes a uniform or uniform block name (32-bit FNV-1a), the key of the reflection
+     * of Program. Evaluated at compile time from a literal, e.g.
+     * `constexpr uint32_t U_MVP = ShaderUtils::hashName("u_mvp");`
+     *
+     * @param name - the name, as written in the shader
+     * @return The hash of the name
+     */
+    constexpr uint32_t hashName(std::string_view name)
+    {
+        uint32_t hash = 2166136261u;
+        for (char c : name)
+            hash = (hash ^ (uint8_t)c) * 16777619u;
+        return hash;
+    }
+
+    /**
+     * @brief An active uniform of the default block, as reflected at link time
+     * Arrays are reflected as their first element, under both `name` and `name[0]`.
+     */
+    struct UniformInfo
+    {
+        std::string name;
+        GLint location;
+        GLenum type;
+        GLint size;
+    };
+
+    /**
+     * @brief An active uniform block, as reflected at link time
+     */
+    struct UniformBlockInfo
+    {
+        GLuint index;
+        GLint dataSize;
+    };
+
     enum Type
     {
         FRAGMENT_SHADER_TYPE,
         VERTEX_SHADER_TYPE,
     };
 
+    /**
+     * @brief The state of a program submitted with `Program::submitProgram`
+     */
+    enum ProgramStatus
+    {
+        /**
+         * @brief No program is being compiled
+         */
+        PROGRAM_IDLE,
+
+        /**
+         * @brief The driver is still compiling or linking: the previous program is in place
+         */
+        PROGRAM_PENDING,
+
+        /**
+         * @brief The program has just replaced the previous one, and has been reflected
+         */
+        PROGRAM_READY,
+
+        /**
+         * @brief The compilation or the link failed, the error is logged: the previous
+         * program is kept
+         */
+        PROGRAM_FAILED,
+    };
+
+    /**
+     * @brief Lets the driver compile and link on its own threads (KHR_parallel_shader_compile
+     * or ARB_parallel_shader_compile), so that `Program::pollProgram` never waits for it.
+     * Without it, a submitted program is waited for when polled. Needs a current context.
+     *
+     * @param getProcAddress - the loader of the window system, e.g. glfwGetProcAddress
+     * @param threads - the number of compiler threads, 0xFFFFFFFF to let the driver choose
+     * @return false if the driver compiles on the calling thread
+     */
+    bool enableParallelCompile(GLUtils::ProcAddress (*getProcAddress)(const char *), GLuint threads = 0xFFFFFFFF);
+
+    /**
+     * @brief Compiled shader stages, shared by the programs using it (`Program::setStageCache`)
+     * and kept across reloads: a stage whose source is unchanged is not compiled again, e.g. a
+     * fragment shader common to several programs. A stage is deleted once no program, linked
+     * or submitted, uses it. Must outlive its programs.
+     */
+    struct StageCache
+    {
+
+    private:
+        struct Stage
+        {
+            unsigned int shader;
+            std::size_t references;
+        };
+
+        /**
+         * @brief The stages by hash of their type and source, and the hashes by shader
+         */
+        std::unordered_map<uint64_t, Stage> stages;
+        std::unordered_map<unsigned int, uint64_t> keys;
+
+        std::size_t compiled = 0;
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        StageCache();
+
+        /**
+         * @brief Destructor, deletes the stages
+         */
+        ~StageCache();
+
+        StageCache(const StageCache &) = delete;
+        StageCache &operator=(const StageCache &) = delete;
+
+        /**
+         * @brief Returns the shader compiled from a source, starting its compilation (without
+         * waiting for it) if the cache has none
+         *
+         * @param shader_type - the type: fragment or vertex
+         * @param shader_source - the source code, which needs no null terminator
+         * @return The shader, to `release` once unused
+         */
+        unsigned int acquire(const Type shader_type, std::string_view shader_source);
+
+        /**
+         * @brief Releases a shader returned by `acquire`, deleted after its last user
+         */
+        void release(unsigned int shader);
+
+        /**
+         * @brief Returns the number of stages compiled so far, cache misses
+         */
+        std::size_t getCompileCount() const;
+
+        /**
+         * @brief Returns the number of stages in use
+         */
+        std::size_t size() const;
+    };
+
     struct Program
     {
 
@@ -36,6 +190,95 @@ namespace ShaderUtils
          */
         bool registered = false;
 
+        /**
+         * @brief The directory of the program binary cache, empty if disabled, and the
+         * sources kept until the program is registered, see `setBinaryCache`
+         */
+        std::string cacheDirectory;
+        std::string vertexSource;
+        std::string fragmentSource;
+
+        /**
+         * @brief Stores if the program has been loaded from the binary cache
+         */
+        bool fromBinaryCache = false;
+
+        /**
+         * @brief The program submitted by `submitProgram` and its shaders, until it replaces
+         * `program`. Its shaders are absent if it comes from the binary cache.
+         */
+        std::optional<unsigned int> pendingProgram = std::nullopt;
+        std::optional<unsigned int> pendingVertexShader = std::nullopt;
+        std::optional<unsigned int> pendingFragmentShader = std::nullopt;
+        uint64_t pendingKey = 0;
+
+        /**
+         * @brief The stage cache of `submitProgram`, if any, and the stages it gave to the
+         * registered program
+         */
+        StageCache *stageCache = nullptr;
+        std::optional<unsigned int> linkedVertexShader = std::nullopt;
+        std::optional<unsigned int> linkedFragmentShader = std::nullopt;
+
+        /**
+         * @brief Deletes the submitted program and its shaders
+         */
+        void discardPending();
+
+        /**
+         * @brief Deletes a shader, or releases it to the stage cache
+         */
+        void releaseShader(std::optional<unsigned int> &shader);
+
+        /**
+         * @brief Deletes the registered program, then registers and reflects a linked one
+         *
+         * @param linked - the linked program
+         * @param binary - whether it comes from the binary cache
+         */
+        void replaceProgram(unsigned int linked, bool binary);
+
+        /**
+         * @brief The active uniforms and uniform blocks of the program, by hashed name
+         */
+        std::unordered_map<uint32_t, UniformInfo> uniforms;
+        std::unordered_map<uint32_t, UniformBlockInfo> uniformBlocks;
+
+        /**
+         * @brief Enumerates the active uniforms and uniform blocks of the linked program
+         */
+        void reflect();
+
+        /**
+         * @brief Returns the location of a uniform, or -1 if it is not active or its GL type
+         * isn't one of `types` (which logs an error)
+         */
+        GLint typedLocation(uint32_t name, std::initializer_list<GLenum> types) const;
+
+        /**
+         * @brief Compiles a shader stage, logs the error if any
+         */
+        bool compileShader(const Type shader_type, const char *shader_source);
+
+        /**
+         * @brief Returns the key of the sources in the binary cache: the 64-bit FNV-1a hash of
+         * both sources and of the vendor, renderer and version strings of the driver
+         */
+        uint64_t binaryKey(std::string_view vertex_source, std::string_view fragment_source) const;
+
+        /**
+         * @brief Loads a program from the binary cache
+         *
+         * @return The program, 0 if there is no binary or the driver rejected it (e.g. after
+         * an update)
+         */
+        unsigned int loadBinary(uint64_t key);
+
+        /**
+         * @brief Stores the binary of the linked program in the cache, logs a warning on failure
+         */
+        void saveBinary(uint64_t key) const;
+
     public:
         /**
          * @brief Constructor
@@ -47,6 +290,24 @@ namespace ShaderUtils
          */
         ~Program();
 
+        /**
+         * @brief Enables the on-disk program binary cache (glProgramBinary, GL 4.1), before
+         * `registerShader`: the shaders are then compiled by `registerProgram`, only if the
+         * cache has no binary for their sources on this driver. Without binary format, the
+         * program is always compiled.
+         *
+         * @param directory - the cache directory, created if needed
+         */
+        void setBinaryCache(const std::string &directory);
+
+        /**
+         * @brief Shares the compiled stages of `submitProgram` with other programs and across
+         * reloads: only the stages whose source changed are compiled again
+         *
+         * @param stages - the stage cache, which must outlive the program
+         */
+        void setStageCache(StageCache &stages);
+
         /**
          * @brief Register a shader
          *
@@ -60,6 +321,8 @@ namespace ShaderUtils
         /**
          * @brief Register the GPU program (or shader), after compilation
          * of the fragment and vertex shaders.
+         * The uniforms and uniform blocks are reflected again: locations from a previous
+         * registration must not be reused.
          *
          * @param erase_if_registered Erase the current program if one is already registered
          * @return true The shader has been successfully registered
@@ -67,6 +330,36 @@ namespace ShaderUtils
          */
         bool registerProgram(bool erase_if_registered);
 
+        /**
+         * @brief Starts compiling and linking a program, without waiting for the driver: the
+         * registered program stays in use until `pollProgram` returns PROGRAM_READY. Submit
+         * all the programs before polling any, so that the driver compiles them together.
+         * A program submitted before and not ready yet is discarded.
+         *
+         * The sources are not copied, e.g. the views of embedded or mapped files (see
+         * ShaderLoader): they need no null terminator.
+         *
+         * @param vertex_source - the source code of the vertex shader
+         * @param fragment_source - the source code of the fragment shader
+         */
+        void submitProgram(std::string_view vertex_source, std::string_view fragment_source);
+
+        /**
+         * @brief Checks the submitted program, e.g. once per frame: once linked, it replaces
+         * the registered one, which is deleted, and is reflected. It is not bound.
+         * Waits for the driver unless `enableParallelCompile` succeeded.
+         *
+         * @return The status of the submitted program
+         */
+        ProgramStatus pollProgram();
+
+        /**
+         * @brief Waits for the submitted program, then does as `pollProgram`
+         *
+         * @return The status of the submitted program: never PROGRAM_PENDING
+         */
+        ProgramStatus finishProgram();
+
         /**
          * @brief Returns the GPU program ID object, as optional
          *
@@ -78,6 +371,56 @@ namespace ShaderUtils
          * @brief Returns if the GPU program object has been registered or not
          */
         bool programIsRegistered() const;
+
+        /**
+         * @brief Returns if the registered program has been loaded from the binary cache,
+         * without compiling
+         */
+        bool isFromBinaryCache() const;
+
+        /**
+         * @brief Returns the reflection of an active uniform, NULL if there is none
+         *
+         * @param name - the hash of the name, see `hashName`
+         */
+        const UniformInfo *findUniform(uint32_t name) const;
+
+        /**
+         * @brief Returns the reflection of an active uniform block, NULL if there is none
+         *
+         * @param name - the hash of the name, see `hashName`
+         */
+        const UniformBlockInfo *findUniformBlock(uint32_t name) const;
+
+        /**
+         * @brief Returns the location of a uniform, -1 if it is not active, e.g. optimized out
+         *
+         * @param name - the hash of the name, see `hashName`
+         */
+        GLint getUniformLocation(uint32_t name) const;
+
+        /**
+         * @brief Typed setters: set a uniform of the program, which doesn't need to be in use
+         * (glProgramUniform). Nothing is sent if the uniform is not active; an error is logged
+         * if its GL type doesn't match the value.
+         *
+         * @param name - the hash of the name, see `hashName`
+         * @param value - the value: int for int, bool and sampler uniforms
+         * @return true if the value has been sent
+         */
+        bool setUniform(uint32_t name, GLint value) const;
+        bool setUniform(uint32_t name, GLfloat value) const;
+        bool setUniform(uint32_t name, const glm::vec2 &value) const;
+        bool setUniform(uint32_t name, const glm::mat4 &value) const;
+
+        /**
+         * @brief Assigns a binding point to a uniform block
+         *
+         * @param name - the hash of the block name, see `hashName`
+         * @param binding - the binding point, see glBindBufferRange
+         * @return false if the block is not active
+         */
+        bool bindUniformBlock(uint32_t name, GLuint binding) const;
     };
 
 }
@@ -0,0 +1,108 @@
+#ifndef _STATE_CACHE_H
+#define _STATE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+#include "../../../glm/glm/glm.hpp"
+
+namespace StateUtils
+{
+
+    /**
+     * @brief The GL calls of a frame going through a StateCache
+     */
+    struct StateCounters
+    {
+        /**
+         * @brief The calls sent to GL
+         */
+        std::size_t issued = 0;
+
+        /**
+         * @brief The calls skipped, because the state was already set
+         */
+        std::size_t elided = 0;
+    };
+
+    /**
+     * @brief Shadows the bound program, vertex array, buffers and uniform values, so that
+     * setting a state which is already set doesn't reach GL
+     * The cache assumes every change of these states goes through it: call `invalidate`
+     * after binding or deleting objects directly, e.g. after ShaderUtils::Program::registerProgram.
+     */
+    struct StateCache
+    {
+
+    private:
+        GLuint program = 0;
+        GLuint vertexArray = 0;
+
+        /**
+         * @brief The buffer bound to each target. GL_ELEMENT_ARRAY_BUFFER is part of the vertex
+         * array state, so it is kept per vertex array.
+         */
+        std::unordered_map<GLuint, GLuint> buffers;
+        std::unordered_map<GLuint, GLuint> elementBuffers;
+
+        /**
+         * @brief The bytes of the uniform values, by program and location
+         */
+        std::unordered_map<uint64_t, std::vector<unsigned char>> uniforms;
+
+        StateCounters counters;
+
+        /**
+         * @brief Stores the value of a uniform of the bound program
+         *
+         * @return true if the value changed and has to be sent
+         */
+        bool uniformChanged(GLint location, const void *value, std::size_t size);
+
+    public:
+        /**
+         * @brief glUseProgram, if `id` isn't already in use
+         */
+        void useProgram(GLuint id);
+
+        /**
+         * @brief glBindVertexArray, if `id` isn't already bound
+         */
+        void bindVertexArray(GLuint id);
+
+        /**
+         * @brief glBindBuffer, if `id` isn't already bound to `target`
+         */
+        void bindBuffer(GLenum target, GLuint id);
+
+        /**
+         * @brief glUniform* on the program in use, if the value changed since the last call.
+         * Locations of -1 are ignored, as GL does.
+         */
+        void uniform1i(GLint location, GLint value);
+        void uniform1f(GLint location, GLfloat value);
+        void uniform2f(GLint location, GLfloat x, GLfloat y);
+        void uniformMatrix4(GLint location, const glm::mat4 &value);
+
+        /**
+         * @brief Forgets everything, the next calls are all issued
+         */
+        void invalidate();
+
+        /**
+         * @brief Returns the counters of the frame, and starts a new one
+         */
+        StateCounters endFrame();
+    };
+}
+
+#endif /* _STATE_CACHE_H */
@@ -0,0 +1,111 @@
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ThreadUtils
+{
+
+    /**
+     * @brief A pool of worker threads, each one with its own task queue
+     * A worker runs its own tasks last in, first out, and steals the oldest task of another worker
+     * once its queue is empty, so uneven tasks still keep every thread busy.
+     */
+    struct ThreadPool
+    {
+
+    private:
+        /**
+         * @brief The task queue of one worker
+         */
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> threads;
+
+        /**
+         * @brief Guards the sleeping workers and the waiting callers
+         */
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        /**
+         * @brief The number of tasks waiting in the queues: counted once pushed, so a worker
+         * may take a task first and briefly bring it below zero
+         */
+        std::atomic<std::ptrdiff_t> queued{0};
+
+        /**
+         * @brief The number of submitted tasks which are not finished yet
+         */
+        std::atomic<std::size_t> pending{0};
+
+        /**
+         * @brief The queue receiving the next submitted task, round robin
+         */
+        std::atomic<std::size_t> next{0};
+
+        bool stopping = false;
+
+        /**
+         * @brief Pops a task from the worker queue, or steals one from another worker
+         *
+         * @param worker - the index of the worker
+         * @param task - the task to run
+         * @return true A task has been found
+         * @return false Every queue is empty
+         */
+        bool pop(const std::size_t worker, std::function<void()> &task);
+
+        /**
+         * @brief The loop run by each worker thread
+         */
+        void run(const std::size_t worker);
+
+    public:
+        /**
+         * @brief Constructor, starts the worker threads
+         *
+         * @param workers - the number of threads, one per hardware thread by default
+         */
+        explicit ThreadPool(unsigned int workers = std::thread::hardware_concurrency());
+
+        /**
+         * @brief Destructor, finishes the submitted tasks then joins the worker threads
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * @brief Queues a task, it will run on one of the worker threads
+         */
+        void submit(std::function<void()> task);
+
+        /**
+         * @brief Blocks until every submitted task is finished
+         */
+        void wait();
+
+        /**
+         * @brief Returns the number of worker threads
+         */
+        std::size_t size() const;
+    };
+}
+
+#endif /* _THREAD_POOL_H */
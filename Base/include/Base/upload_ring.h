@@ -0,0 +1,133 @@
+#ifndef _UPLOAD_RING_H
+#define _UPLOAD_RING_H
+
+#include <cstddef>
+#include <vector>
+#ifdef __APPLE__
+/* Defined before OpenGL and GLUT includes to avoid deprecation messages */
+#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_GLCOREARB
+#include <GLFW/glfw3.h>
+#else
+#include <GL/gl.h>
+#endif
+
+/* GL 4.4, missing from the GL 4.1 headers */
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace GLUtils
+{
+
+    /**
+     * @brief The number of frames the GPU may lag behind, see UploadRing
+     */
+    const unsigned int UPLOAD_RING_FRAMES = 3;
+
+    /**
+     * @brief A buffer for the data sent every frame, which is written with a memcpy instead of
+     * glBufferSubData, the call that stalls when the GPU still reads the previous contents.
+     *
+     * With BufferStorage (see `loadExtensions`), the buffer holds one region per frame in flight
+     * and stays mapped: a region is written again once the fence placed after its last frame
+     * is signaled. Without it (GL 4.1), the buffer holds one region, orphaned by each frame
+     * with glBufferData(NULL), and every write maps its range unsynchronized.
+     * Writes are read by the GPU from `getBuffer()`, e.g. with glCopyBufferSubData or
+     * glBindBufferRange, at the offset `write` returns. GL_COPY_READ_BUFFER is left unbound.
+     */
+    struct UploadRing
+    {
+
+    private:
+        GLuint buffer = 0;
+
+        /**
+         * @brief The bytes of a frame, and the number of regions of the buffer
+         */
+        GLsizeiptr frameSize;
+        unsigned int regionCount;
+
+        /**
+         * @brief The whole buffer, when mapped persistently
+         */
+        unsigned char *mapped = nullptr;
+
+        /**
+         * @brief The region of the current frame, and the bytes written in it
+         */
+        unsigned int region = 0;
+        GLsizeiptr used = 0;
+
+        /**
+         * @brief The fence placed after the last frame of each region, if any
+         */
+        std::vector<GLsync> fences;
+
+        /**
+         * @brief The number of frames which waited for the GPU
+         */
+        std::size_t waits = 0;
+
+    public:
+        /**
+         * @brief Creates the buffer, the context must be current
+         *
+         * @param frameSize - the largest number of bytes written in a frame
+         * @param frames - the number of frames in flight, when mapped persistently
+         */
+        UploadRing(GLsizeiptr frameSize, unsigned int frames = UPLOAD_RING_FRAMES);
+
+        /**
+         * @brief Destructor, deletes the buffer and the fences
+         */
+        ~UploadRing();
+
+        UploadRing(const UploadRing &) = delete;
+        UploadRing &operator=(const UploadRing &) = delete;
+
+        /**
+         * @brief Starts a frame: waits until the GPU is done with the region, or orphans the buffer
+         */
+        void beginFrame();
+
+        /**
+         * @brief Copies data into the region of the current frame
+         *
+         * @param data - the bytes to copy
+         * @param size - the number of bytes
+         * @param alignment - the alignment of the offset in the buffer, e.g.
+         * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for glBindBufferRange
+         * @param offset - set to the offset of the copy in the buffer, on success
+         * @return false if the frame has no room left or the buffer cannot be mapped: nothing
+         * is copied, and the room of the frame is left as is
+         */
+        bool write(const void *data, GLsizeiptr size, GLsizeiptr alignment, GLintptr &offset);
+
+        /**
+         * @brief Ends a frame, after the calls reading its writes have been issued
+         */
+        void endFrame();
+
+        /**
+         * @brief Returns the buffer ID
+         */
+        GLuint getBuffer() const;
+
+        /**
+         * @brief Returns whether the buffer is mapped persistently, rather than orphaned
+         */
+        bool isPersistent() const;
+
+        /**
+         * @brief Returns the number of frames which had to wait for the GPU: more frames
+         * in flight are needed if it keeps growing
+         */
+        std::size_t getWaits() const;
+    };
+}
+
+#endif /* _UPLOAD_RING_H */
@@ -0,0 +1,68 @@
+#pragma once
+
+// The screen-space expansion common to the line vertex shaders, included by them.
+// Compiled with LINE_MITER for miter joins, otherwise a join takes the normal of the
+// segment before it. The miters longer than MITER_LIMIT thicknesses on screen are beveled
+// that way too, whatever the CPU tessellation chose in model space.
+
+#ifndef MITER_LIMIT
+#define MITER_LIMIT 4.0
+#endif
+
+// Returns the normal of the line at `current`, in screen space, scaled by the length of its
+// join in thicknesses: 1 along a segment, longer at a miter. A neighbour equal to `current`
+// marks an end of the line.
+vec2 joinNormal(vec2 previousScreen, vec2 currentScreen, vec2 nextScreen) {
+  float len = 1.0;
+
+  //starting point uses (next - current)
+  vec2 dir = vec2(0.0);
+  if (currentScreen == previousScreen) {
+    dir = normalize(nextScreen - currentScreen);
+  }
+  //ending point uses (current - previous)
+  else if (currentScreen == nextScreen) {
+    dir = normalize(currentScreen - previousScreen);
+  }
+  //somewhere in middle, needs a join
+  else {
+    //get directions from (C - B) and (B - A)
+    vec2 dirA = normalize((currentScreen - previousScreen));
+#ifdef LINE_MITER
+    vec2 dirB = normalize((nextScreen - currentScreen));
+    //now compute the miter join normal and length
+    vec2 tangent = normalize(dirA + dirB);
+    vec2 perp = vec2(-dirA.y, dirA.x);
+    vec2 miter = vec2(-tangent.y, tangent.x);
+    float cosine = dot(miter, perp);
+    //past the limit, bevel: the normal of the segment before, at the thickness
+    if (cosine < 1.0 / MITER_LIMIT) {
+      dir = dirA;
+    } else {
+      dir = tangent;
+      len = 1.0 / cosine;
+    }
+#else
+    dir = dirA;
+#endif
+  }
+  return vec2(-dir.y, dir.x) * len;
+}
+
+// Pushes `current` by half the thickness along the normal of the line, on the side of
+// `orientation` (-1 or 1); the neighbours give the direction of the line
+vec4 expandLine(vec4 previousProjected, vec4 currentProjected, vec4 nextProjected, float orientation, float aspect, float thickness) {
+  vec2 aspectVec = vec2(aspect, 1.0);
+
+  //get 2D screen space with W divide and aspect correction
+  vec2 currentScreen = currentProjected.xy / currentProjected.w * aspectVec;
+  vec2 previousScreen = previousProjected.xy / previousProjected.w * aspectVec;
+  vec2 nextScreen = nextProjected.xy / nextProjected.w * aspectVec;
+
+  vec2 normal = joinNormal(previousScreen, currentScreen, nextScreen);
+  normal *= thickness/2.0;
+  normal.x /= aspect;
+
+  vec4 offset = vec4(normal * orientation, 0.0, 1.0);
+  return currentProjected + offset;
+}
@@ -0,0 +1,158 @@
+#include "Base/file_watcher.h"
+#include "Base/logs.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::string normalize(const std::string &path)
+    {
+        std::error_code errorCode;
+        return std::filesystem::absolute(path, errorCode).lexically_normal().string();
+    }
+
+    std::filesystem::file_time_type lastWriteTime(const std::string &path)
+    {
+        // A missing file, e.g. in the middle of a save, has the minimal time
+        std::error_code errorCode;
+        return std::filesystem::last_write_time(path, errorCode);
+    }
+}
+
+ShaderUtils::FileWatcher::FileWatcher(const std::vector<std::string> &paths)
+{
+    for (const std::string &path : paths)
+        files.emplace(normalize(path), path);
+#ifdef __linux__
+    inotify = inotify_init1(IN_CLOEXEC);
+    if (inotify >= 0 && pipe(wakeup) == 0)
+    {
+        for (const auto &file : files)
+        {
+            const std::string directory = std::filesystem::path(file.first).parent_path().string();
+            bool watched = false;
+            for (const auto &known : directories)
+                watched |= known.second == directory;
+            if (watched)
+                continue;
+            // Written in place, or renamed over the file
+            const int descriptor = inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (descriptor >= 0)
+                directories.emplace(descriptor, directory);
+            else
+                warning("cannot watch " << directory);
+        }
+    }
+    else
+    {
+        warning("inotify is not available, the files are polled");
+        if (inotify >= 0)
+            close(inotify);
+        inotify = -1;
+    }
+#endif
+    thread = std::thread(&FileWatcher::run, this);
+}
+
+ShaderUtils::FileWatcher::~FileWatcher()
+{
+    stopping = true;
+    {
+        // Set before the thread waits, or seen by its predicate
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    stop.notify_all();
+#ifdef __linux__
+    if (inotify >= 0)
+    {
+        const char byte = 0;
+        if (write(wakeup[1], &byte, 1) < 0)
+            warning("cannot wake the file watcher up");
+    }
+#endif
+    thread.join();
+#ifdef __linux__
+    if (inotify >= 0)
+    {
+        close(inotify);
+        close(wakeup[0]);
+        close(wakeup[1]);
+    }
+#endif
+}
+
+void ShaderUtils::FileWatcher::notify(const std::string &path)
+{
+    auto file = files.find(path);
+    if (file == files.end())
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (std::find(changes.begin(), changes.end(), file->second) == changes.end())
+        changes.push_back(file->second);
+}
+
+void ShaderUtils::FileWatcher::run()
+{
+#ifdef __linux__
+    if (inotify >= 0)
+    {
+        alignas(inotify_event) char buffer[4096];
+        pollfd descriptors[2] = {{inotify, POLLIN, 0}, {wakeup[0], POLLIN, 0}};
+        while (!stopping)
+        {
+            if (poll(descriptors, 2, -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (descriptors[1].revents != 0)
+                break;
+            const ssize_t length = read(inotify, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const inotify_event *event = (const inotify_event *)(buffer + offset);
+                auto directory = directories.find(event->wd);
+                if (event->len > 0 && directory != directories.end())
+                    notify((std::filesystem::path(directory->second) / event->name).string());
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+        return;
+    }
+#endif
+    std::unordered_map<std::string, std::filesystem::file_time_type> times;
+    for (const auto &file : files)
+        times.emplace(file.first, lastWriteTime(file.first));
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop.wait_for(lock, WATCH_PERIOD, [this]()
+                          { return stopping.load(); }))
+    {
+        // notify takes the lock
+        lock.unlock();
+        for (auto &time : times)
+        {
+            const std::filesystem::file_time_type modified = lastWriteTime(time.first);
+            if (modified == time.second)
+                continue;
+            time.second = modified;
+            notify(time.first);
+        }
+        lock.lock();
+    }
+}
+
+std::vector<std::string> ShaderUtils::FileWatcher::takeChanges()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> taken;
+    taken.swap(changes);
+    return taken;
+}
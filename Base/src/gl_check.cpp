@@ -0,0 +1,127 @@
+#include "Base/gl_check.h"
+#include "Base/logs.h"
+#include <iostream>
+
+namespace
+{
+    GLUtils::CheckMode mode = GLUtils::CHECK_ALWAYS;
+    unsigned int period = GLUtils::GL_CHECK_PERIOD;
+
+    /*
+     * The frames ended so far, and whether the current one is checked.
+     */
+    std::size_t frame = 0;
+    bool sampling = true;
+
+    /*
+     * The call in progress, for the debug output callback.
+     */
+    const GLUtils::CallSite *current = nullptr;
+
+    std::vector<GLUtils::CheckError> errors;
+    std::size_t errorCount = 0;
+
+    typedef void (*DebugProc)(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam);
+    typedef void (*DebugMessageCallbackProc)(DebugProc callback, const void *userParam);
+
+    /*
+     * Keeps and logs the first errors, counts the others.
+     */
+    void report(const GLUtils::CallSite *site, GLenum code, const char *message)
+    {
+        errorCount++;
+        if (errors.size() >= GLUtils::GL_CHECK_MAX_ERRORS)
+            return;
+        GLUtils::CheckError checkError;
+        checkError.site = site ? *site : GLUtils::CallSite{"", "", 0};
+        checkError.code = code;
+        checkError.frame = frame;
+        checkError.message = message;
+        errors.push_back(checkError);
+        if (site)
+        {
+            error(site->file << ":" << site->line << ": " << site->call << " failed with 0x" << std::hex << code << std::dec << " " << message);
+        }
+        else
+        {
+            error("GL error 0x" << std::hex << code << std::dec << " " << message);
+        }
+    }
+
+    void debugCallback(GLenum /*source*/, GLenum type, GLuint id, GLenum /*severity*/, GLsizei /*length*/, const GLchar *message, const void */*userParam*/)
+    {
+        if (type == GL_DEBUG_TYPE_ERROR)
+            report(current, id, message);
+    }
+}
+
+void GLUtils::setCheckMode(GLUtils::CheckMode checkMode, unsigned int checkPeriod)
+{
+    mode = checkMode;
+    period = checkPeriod > 0 ? checkPeriod : 1;
+    sampling = mode != CHECK_SAMPLED || frame % period == 0;
+}
+
+GLUtils::CheckMode GLUtils::getCheckMode()
+{
+    return mode;
+}
+
+bool GLUtils::enableDebugOutput(GLUtils::ProcAddress (*getProcAddress)(const char *))
+{
+    if (!GLUtils::supports(4, 3, "GL_KHR_debug"))
+        return false;
+    DebugMessageCallbackProc debugMessageCallback = (DebugMessageCallbackProc)getProcAddress("glDebugMessageCallback");
+    if (!debugMessageCallback)
+        return false;
+    // The errors already raised are not reported to the callback
+    while (glGetError() != GL_NO_ERROR)
+        ;
+    debugMessageCallback(&debugCallback, nullptr);
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    GLUtils::setCheckMode(CHECK_DEBUG_OUTPUT);
+    return true;
+}
+
+void GLUtils::beginCall(const GLUtils::CallSite &site)
+{
+    current = &site;
+}
+
+void GLUtils::endCall(const GLUtils::CallSite &site)
+{
+    current = nullptr;
+    if (mode == CHECK_OFF || mode == CHECK_DEBUG_OUTPUT || !sampling)
+        return;
+    // Several errors may be pending
+    for (GLenum code = GLUtils::gl().GetError(); code != GL_NO_ERROR; code = GLUtils::gl().GetError())
+        report(&site, code, "");
+}
+
+void GLUtils::endCheckFrame()
+{
+    frame++;
+    const bool sampled = sampling;
+    sampling = mode != CHECK_SAMPLED || frame % period == 0;
+    // The errors of the unchecked frames are still pending: not blamed on the next call
+    if (mode == CHECK_SAMPLED && sampling && !sampled)
+        for (GLenum code = GLUtils::gl().GetError(); code != GL_NO_ERROR; code = GLUtils::gl().GetError())
+            report(nullptr, code, "raised in an unchecked frame");
+}
+
+const std::vector<GLUtils::CheckError> &GLUtils::getErrors()
+{
+    return errors;
+}
+
+std::size_t GLUtils::getErrorCount()
+{
+    return errorCount;
+}
+
+void GLUtils::clearErrors()
+{
+    errors.clear();
+    errorCount = 0;
+}
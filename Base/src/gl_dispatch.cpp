@@ -0,0 +1,928 @@
+#include "Base/gl_dispatch.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string_view>
+
+namespace
+{
+    GLUtils::Recorder *recorder = nullptr;
+
+    /*
+     * Appends the bytes of the arguments to the command stream.
+     */
+    void append() {}
+
+    template <typename Argument, typename... Arguments>
+    void append(const Argument &argument, const Arguments &...arguments)
+    {
+        const std::size_t size = recorder->stream.size();
+        recorder->stream.resize(size + sizeof(Argument));
+        std::memcpy(&recorder->stream[size], &argument, sizeof(Argument));
+        append(arguments...);
+    }
+
+    template <typename... Arguments>
+    void write(GLUtils::Call call, const Arguments &...arguments)
+    {
+        recorder->calls[call]++;
+        recorder->stream.push_back((uint8_t)call);
+        append(arguments...);
+    }
+
+    /*
+     * The GL type of a GLSL type name, 0 if unknown.
+     */
+    GLenum uniformType(const std::string &type)
+    {
+        static const std::unordered_map<std::string, GLenum> types = {
+            {"float", GL_FLOAT}, {"vec2", GL_FLOAT_VEC2}, {"vec3", GL_FLOAT_VEC3}, {"vec4", GL_FLOAT_VEC4},
+            {"int", GL_INT}, {"ivec2", GL_INT_VEC2}, {"ivec3", GL_INT_VEC3}, {"ivec4", GL_INT_VEC4},
+            {"uint", GL_UNSIGNED_INT}, {"bool", GL_BOOL},
+            {"mat2", GL_FLOAT_MAT2}, {"mat3", GL_FLOAT_MAT3}, {"mat4", GL_FLOAT_MAT4},
+            {"sampler1D", GL_SAMPLER_1D}, {"sampler2D", GL_SAMPLER_2D}, {"sampler3D", GL_SAMPLER_3D},
+            {"samplerCube", GL_SAMPLER_CUBE}, {"sampler2DArray", GL_SAMPLER_2D_ARRAY}, {"samplerBuffer", GL_SAMPLER_BUFFER}};
+        auto found = types.find(type);
+        return found != types.end() ? found->second : 0;
+    }
+
+    /*
+     * Returns the lines of a shader the compiler sees, without the comments nor the
+     * directives: #ifdef and #ifndef follow the #defines of the source, #if is always taken.
+     */
+    std::string activeCode(std::string_view source)
+    {
+        std::string code;
+        std::vector<std::string> defines;
+        // Whether each enclosing branch is taken, and whether a branch of its conditional was
+        std::vector<std::pair<bool, bool>> branches;
+        bool comment = false;
+        std::size_t start = 0;
+        while (start < source.size())
+        {
+            std::size_t end = std::min(source.find('\n', start), source.size());
+            std::string_view line = source.substr(start, end - start);
+            start = end + 1;
+            std::string text;
+            for (std::size_t i = 0; i < line.size(); i++)
+            {
+                if (comment)
+                {
+                    if (line.substr(i, 2) == "*/")
+                    {
+                        comment = false;
+                        i++;
+                    }
+                }
+                else if (line.substr(i, 2) == "/*")
+                {
+                    comment = true;
+                    i++;
+                }
+                else if (line.substr(i, 2) == "//")
+                {
+                    break;
+                }
+                else
+                {
+                    text += line[i];
+                }
+            }
+
+            std::istringstream words(text);
+            std::string directive, name;
+            words >> directive >> name;
+            const bool taken = std::all_of(branches.begin(), branches.end(), [](const std::pair<bool, bool> &branch)
+                                           { return branch.first; });
+            if (directive == "#ifdef" || directive == "#ifndef")
+            {
+                const bool defined = std::find(defines.begin(), defines.end(), name) != defines.end();
+                const bool branch = defined == (directive == "#ifdef");
+                branches.push_back({branch, branch});
+            }
+            else if (directive == "#if")
+            {
+                branches.push_back({true, true});
+            }
+            else if ((directive == "#elif" || directive == "#else") && !branches.empty())
+            {
+                branches.back().first = !branches.back().second;
+                branches.back().second = true;
+            }
+            else if (directive == "#endif" && !branches.empty())
+            {
+                branches.pop_back();
+            }
+            else if (directive == "#define" && taken)
+            {
+                defines.push_back(name);
+            }
+            else if (directive == "#undef" && taken)
+            {
+                defines.erase(std::remove(defines.begin(), defines.end(), name), defines.end());
+            }
+            else if (taken && (directive.empty() || directive[0] != '#'))
+            {
+                code += text;
+                code += '\n';
+            }
+        }
+        return code;
+    }
+
+    /*
+     * Appends the uniforms declared in the code of a shader, outside of the blocks, and the
+     * names of its uniform blocks.
+     */
+    void declareUniforms(const std::string &code, std::vector<GLUtils::RecordedUniform> &uniforms, std::vector<std::string> &blocks)
+    {
+        // Identifiers and numbers, and single punctuation characters
+        std::vector<std::string> tokens;
+        for (std::size_t i = 0; i < code.size();)
+        {
+            if (std::isspace((unsigned char)code[i]))
+            {
+                i++;
+                continue;
+            }
+            std::size_t end = i;
+            while (end < code.size() && (std::isalnum((unsigned char)code[end]) || code[end] == '_'))
+                end++;
+            if (end == i)
+                end++;
+            tokens.emplace_back(code, i, end - i);
+            i = end;
+        }
+
+        int depth = 0;
+        for (std::size_t t = 0; t < tokens.size(); t++)
+        {
+            if (tokens[t] == "{")
+                depth++;
+            else if (tokens[t] == "}")
+                depth--;
+            if (depth > 0 || tokens[t] != "uniform")
+                continue;
+            std::size_t type = t + 1;
+            while (type < tokens.size() && (tokens[type] == "lowp" || tokens[type] == "mediump" || tokens[type] == "highp"))
+                type++;
+            if (type + 1 >= tokens.size())
+                break;
+            // `uniform Block { ... }`: its members have no location
+            if (tokens[type + 1] == "{")
+            {
+                blocks.push_back(tokens[type]);
+                continue;
+            }
+            // The names separated with commas, each maybe an array or initialized
+            std::size_t name = type + 1;
+            while (name < tokens.size())
+            {
+                GLUtils::RecordedUniform uniform = {tokens[name], uniformType(tokens[type]), 1};
+                if (name + 2 < tokens.size() && tokens[name + 1] == "[")
+                {
+                    uniform.name += "[0]";
+                    uniform.size = std::atoi(tokens[name + 2].c_str());
+                }
+                uniforms.push_back(uniform);
+                while (name < tokens.size() && tokens[name] != "," && tokens[name] != ";")
+                    name++;
+                if (name >= tokens.size() || tokens[name] == ";")
+                    break;
+                name++;
+            }
+            t = name;
+        }
+    }
+
+    /*
+     * Returns the index of a name in a list, -1 if missing.
+     */
+    GLint indexOf(const std::vector<std::string> &names, const std::string &name)
+    {
+        auto found = std::find(names.begin(), names.end(), name);
+        return found != names.end() ? (GLint)(found - names.begin()) : -1;
+    }
+
+    /*
+     * Copies a name into the buffer of a glGetActive* call, truncated as GL does.
+     */
+    void copyName(const std::string &name, GLsizei bufSize, GLsizei *length, GLchar *buffer)
+    {
+        const GLsizei copied = bufSize > 0 ? std::min((GLsizei)name.size(), bufSize - 1) : 0;
+        if (bufSize > 0)
+        {
+            std::memcpy(buffer, name.data(), copied);
+            buffer[copied] = '\0';
+        }
+        if (length)
+            *length = copied;
+    }
+
+    void recordAttachShader(GLuint program, GLuint shader)
+    {
+        write(GLUtils::ATTACH_SHADER_CALL, program, shader);
+        recorder->attached[program].push_back(shader);
+    }
+
+    void recordBindBuffer(GLenum target, GLuint buffer)
+    {
+        write(GLUtils::BIND_BUFFER_CALL, target, buffer);
+        recorder->bindings[target] = buffer;
+    }
+
+    void recordBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        write(GLUtils::BIND_BUFFER_RANGE_CALL, target, index, buffer, offset, size);
+    }
+
+    void recordBindTexture(GLenum target, GLuint texture)
+    {
+        write(GLUtils::BIND_TEXTURE_CALL, target, texture);
+    }
+
+    void recordBindVertexArray(GLuint array)
+    {
+        write(GLUtils::BIND_VERTEX_ARRAY_CALL, array);
+    }
+
+    void recordBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+    {
+        write(GLUtils::BUFFER_DATA_CALL, target, size, usage);
+        if (data)
+            recorder->uploadedBytes += size;
+        recorder->storage[recorder->bindings[target]].resize(size);
+    }
+
+    void recordBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+    {
+        write(GLUtils::BUFFER_STORAGE_CALL, target, size, flags);
+        if (data)
+            recorder->uploadedBytes += size;
+        recorder->storage[recorder->bindings[target]].resize(size);
+    }
+
+    void recordBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void */*data*/)
+    {
+        write(GLUtils::BUFFER_SUB_DATA_CALL, target, offset, size);
+        recorder->uploadedBytes += size;
+    }
+
+    void recordClear(GLbitfield mask)
+    {
+        write(GLUtils::CLEAR_CALL, mask);
+    }
+
+    void recordClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+    {
+        write(GLUtils::CLEAR_COLOR_CALL, red, green, blue, alpha);
+    }
+
+    GLenum recordClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+    {
+        write(GLUtils::CLIENT_WAIT_SYNC_CALL, sync, flags, timeout);
+        return GL_ALREADY_SIGNALED;
+    }
+
+    void recordCompileShader(GLuint shader)
+    {
+        write(GLUtils::COMPILE_SHADER_CALL, shader);
+    }
+
+    void recordCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+    {
+        write(GLUtils::COPY_BUFFER_SUB_DATA_CALL, readTarget, writeTarget, readOffset, writeOffset, size);
+        recorder->uploadedBytes += size;
+    }
+
+    GLuint recordCreateProgram()
+    {
+        write(GLUtils::CREATE_PROGRAM_CALL);
+        return recorder->nextName++;
+    }
+
+    GLuint recordCreateShader(GLenum type)
+    {
+        write(GLUtils::CREATE_SHADER_CALL, type);
+        return recorder->nextName++;
+    }
+
+    void recordDeleteBuffers(GLsizei n, const GLuint *buffers)
+    {
+        write(GLUtils::DELETE_BUFFERS_CALL, n);
+        for (GLsizei i = 0; i < n; i++)
+            append(buffers[i]);
+    }
+
+    void recordDeleteProgram(GLuint program)
+    {
+        write(GLUtils::DELETE_PROGRAM_CALL, program);
+    }
+
+    void recordDeleteShader(GLuint shader)
+    {
+        write(GLUtils::DELETE_SHADER_CALL, shader);
+    }
+
+    void recordDeleteSync(GLsync sync)
+    {
+        write(GLUtils::DELETE_SYNC_CALL, sync);
+    }
+
+    void recordDeleteVertexArrays(GLsizei n, const GLuint *arrays)
+    {
+        write(GLUtils::DELETE_VERTEX_ARRAYS_CALL, n);
+        for (GLsizei i = 0; i < n; i++)
+            append(arrays[i]);
+    }
+
+    void recordDrawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        write(GLUtils::DRAW_ARRAYS_CALL, mode, first, count);
+    }
+
+    void recordDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+    {
+        write(GLUtils::DRAW_ARRAYS_INSTANCED_CALL, mode, first, count, instancecount);
+    }
+
+    void recordDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+    {
+        write(GLUtils::DRAW_ELEMENTS_CALL, mode, count, type, indices);
+    }
+
+    void recordEnableVertexAttribArray(GLuint index)
+    {
+        write(GLUtils::ENABLE_VERTEX_ATTRIB_ARRAY_CALL, index);
+    }
+
+    GLsync recordFenceSync(GLenum condition, GLbitfield flags)
+    {
+        write(GLUtils::FENCE_SYNC_CALL, condition, flags);
+        return (GLsync)(uintptr_t)recorder->nextName++;
+    }
+
+    void recordGenBuffers(GLsizei n, GLuint *buffers)
+    {
+        write(GLUtils::GEN_BUFFERS_CALL, n);
+        for (GLsizei i = 0; i < n; i++)
+            buffers[i] = recorder->nextName++;
+    }
+
+    void recordGenTextures(GLsizei n, GLuint *textures)
+    {
+        write(GLUtils::GEN_TEXTURES_CALL, n);
+        for (GLsizei i = 0; i < n; i++)
+            textures[i] = recorder->nextName++;
+    }
+
+    void recordGenVertexArrays(GLsizei n, GLuint *arrays)
+    {
+        write(GLUtils::GEN_VERTEX_ARRAYS_CALL, n);
+        for (GLsizei i = 0; i < n; i++)
+            arrays[i] = recorder->nextName++;
+    }
+
+    void recordGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name)
+    {
+        write(GLUtils::GET_ACTIVE_UNIFORM_CALL, program, index);
+        const std::vector<GLUtils::RecordedUniform> &uniforms = recorder->uniforms[program];
+        const GLUtils::RecordedUniform uniform = index < uniforms.size() ? uniforms[index] : GLUtils::RecordedUniform{"", 0, 0};
+        copyName(uniform.name, bufSize, length, name);
+        *size = uniform.size;
+        *type = uniform.type;
+    }
+
+    void recordGetActiveUniformBlockName(GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei *length, GLchar *uniformBlockName)
+    {
+        write(GLUtils::GET_ACTIVE_UNIFORM_BLOCK_NAME_CALL, program, uniformBlockIndex);
+        const std::vector<std::string> &blocks = recorder->uniformBlocks[program];
+        copyName(uniformBlockIndex < blocks.size() ? blocks[uniformBlockIndex] : "", bufSize, length, uniformBlockName);
+    }
+
+    void recordGetActiveUniformBlockiv(GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint *params)
+    {
+        write(GLUtils::GET_ACTIVE_UNIFORM_BLOCKIV_CALL, program, uniformBlockIndex, pname);
+        *params = 0;
+    }
+
+    GLenum recordGetError()
+    {
+        write(GLUtils::GET_ERROR_CALL);
+        return GL_NO_ERROR;
+    }
+
+    void recordGetIntegerv(GLenum pname, GLint *data)
+    {
+        write(GLUtils::GET_INTEGERV_CALL, pname);
+        // The limits of a typical desktop driver
+        if (pname == GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+            *data = 256;
+        else if (pname == GL_MAX_UNIFORM_BLOCK_SIZE)
+            *data = 65536;
+        else
+            *data = 0;
+    }
+
+    void recordGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void */*binary*/)
+    {
+        write(GLUtils::GET_PROGRAM_BINARY_CALL, program, bufSize);
+        // Nothing to cache: the recorder has no binary formats
+        if (length)
+            *length = 0;
+        *binaryFormat = 0;
+    }
+
+    void recordGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+    {
+        write(GLUtils::GET_PROGRAM_INFO_LOG_CALL, program);
+        if (length)
+            *length = 0;
+        if (bufSize > 0)
+            infoLog[0] = '\0';
+    }
+
+    void recordGetProgramiv(GLuint program, GLenum pname, GLint *params)
+    {
+        write(GLUtils::GET_PROGRAMIV_CALL, program, pname);
+        if (pname == GL_ACTIVE_UNIFORMS)
+            *params = (GLint)recorder->uniforms[program].size();
+        else if (pname == GL_ACTIVE_UNIFORM_BLOCKS)
+            *params = (GLint)recorder->uniformBlocks[program].size();
+        else
+            *params = pname == GL_LINK_STATUS || pname == GL_COMPLETION_STATUS_KHR ? GL_TRUE : 0;
+    }
+
+    void recordGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+    {
+        write(GLUtils::GET_SHADER_INFO_LOG_CALL, shader);
+        if (length)
+            *length = 0;
+        if (bufSize > 0)
+            infoLog[0] = '\0';
+    }
+
+    void recordGetShaderiv(GLuint shader, GLenum pname, GLint *params)
+    {
+        write(GLUtils::GET_SHADERIV_CALL, shader, pname);
+        *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    }
+
+    const GLubyte *recordGetString(GLenum name)
+    {
+        write(GLUtils::GET_STRING_CALL, name);
+        return (const GLubyte *)"GLUtils::Recorder";
+    }
+
+    GLuint recordGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName)
+    {
+        write(GLUtils::GET_UNIFORM_BLOCK_INDEX_CALL, program);
+        const GLint index = indexOf(recorder->uniformBlocks[program], uniformBlockName);
+        return index < 0 ? GL_INVALID_INDEX : (GLuint)index;
+    }
+
+    GLint recordGetUniformLocation(GLuint program, const GLchar *name)
+    {
+        write(GLUtils::GET_UNIFORM_LOCATION_CALL, program);
+        // Arrays are found by `name` and `name[0]`
+        const std::string key = name;
+        bool declared = false;
+        for (const GLUtils::RecordedUniform &uniform : recorder->uniforms[program])
+            declared = declared || uniform.name == key || uniform.name == key + "[0]";
+        if (!declared)
+            return -1;
+        auto location = recorder->locations.emplace(key, (GLint)recorder->locations.size());
+        return location.first->second;
+    }
+
+    void recordLinkProgram(GLuint program)
+    {
+        write(GLUtils::LINK_PROGRAM_CALL, program);
+        // The declarations of all the stages, once each
+        std::vector<GLUtils::RecordedUniform> uniforms;
+        std::vector<std::string> blocks;
+        for (GLuint shader : recorder->attached[program])
+        {
+            for (const GLUtils::RecordedUniform &uniform : recorder->uniforms[shader])
+                if (std::none_of(uniforms.begin(), uniforms.end(), [&](const GLUtils::RecordedUniform &other)
+                                 { return other.name == uniform.name; }))
+                    uniforms.push_back(uniform);
+            for (const std::string &block : recorder->uniformBlocks[shader])
+                if (indexOf(blocks, block) < 0)
+                    blocks.push_back(block);
+        }
+        recorder->attached.erase(program);
+        recorder->uniforms[program] = uniforms;
+        recorder->uniformBlocks[program] = blocks;
+    }
+
+    void *recordMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+        write(GLUtils::MAP_BUFFER_RANGE_CALL, target, offset, length, access);
+        std::vector<uint8_t> &storage = recorder->storage[recorder->bindings[target]];
+        return offset + length <= (GLintptr)storage.size() ? &storage[offset] : nullptr;
+    }
+
+    void recordMultiDrawElements(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei drawcount)
+    {
+        write(GLUtils::MULTI_DRAW_ELEMENTS_CALL, mode, type, drawcount);
+        for (GLsizei i = 0; i < drawcount; i++)
+            append(count[i], indices[i]);
+    }
+
+    void recordMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei drawcount, const GLint *basevertex)
+    {
+        write(GLUtils::MULTI_DRAW_ELEMENTS_BASE_VERTEX_CALL, mode, type, drawcount);
+        for (GLsizei i = 0; i < drawcount; i++)
+            append(count[i], indices[i], basevertex[i]);
+    }
+
+    void recordPolygonMode(GLenum face, GLenum mode)
+    {
+        write(GLUtils::POLYGON_MODE_CALL, face, mode);
+    }
+
+    void recordProgramBinary(GLuint program, GLenum binaryFormat, const void */*binary*/, GLsizei length)
+    {
+        write(GLUtils::PROGRAM_BINARY_CALL, program, binaryFormat, length);
+    }
+
+    void recordProgramParameteri(GLuint program, GLenum pname, GLint value)
+    {
+        write(GLUtils::PROGRAM_PARAMETERI_CALL, program, pname, value);
+    }
+
+    void recordProgramUniform1f(GLuint program, GLint location, GLfloat v0)
+    {
+        write(GLUtils::PROGRAM_UNIFORM1F_CALL, program, location, v0);
+    }
+
+    void recordProgramUniform1i(GLuint program, GLint location, GLint v0)
+    {
+        write(GLUtils::PROGRAM_UNIFORM1I_CALL, program, location, v0);
+    }
+
+    void recordProgramUniform2f(GLuint program, GLint location, GLfloat v0, GLfloat v1)
+    {
+        write(GLUtils::PROGRAM_UNIFORM2F_CALL, program, location, v0, v1);
+    }
+
+    void recordProgramUniformMatrix4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+    {
+        write(GLUtils::PROGRAM_UNIFORM_MATRIX4FV_CALL, program, location, count, transpose);
+        for (GLsizei i = 0; i < 16 * count; i++)
+            append(value[i]);
+    }
+
+    void recordShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length)
+    {
+        write(GLUtils::SHADER_SOURCE_CALL, shader, count);
+        std::string source;
+        for (GLsizei i = 0; i < count; i++)
+            source.append(string[i], length && length[i] >= 0 ? (std::size_t)length[i] : std::strlen(string[i]));
+        std::vector<GLUtils::RecordedUniform> uniforms;
+        std::vector<std::string> blocks;
+        declareUniforms(activeCode(source), uniforms, blocks);
+        recorder->uniforms[shader] = uniforms;
+        recorder->uniformBlocks[shader] = blocks;
+    }
+
+    void recordTexBuffer(GLenum target, GLenum internalformat, GLuint buffer)
+    {
+        write(GLUtils::TEX_BUFFER_CALL, target, internalformat, buffer);
+    }
+
+    void recordUniform1f(GLint location, GLfloat v0)
+    {
+        write(GLUtils::UNIFORM1F_CALL, location, v0);
+    }
+
+    void recordUniform1i(GLint location, GLint v0)
+    {
+        write(GLUtils::UNIFORM1I_CALL, location, v0);
+    }
+
+    void recordUniform2f(GLint location, GLfloat v0, GLfloat v1)
+    {
+        write(GLUtils::UNIFORM2F_CALL, location, v0, v1);
+    }
+
+    void recordUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+    {
+        write(GLUtils::UNIFORM_BLOCK_BINDING_CALL, program, uniformBlockIndex, uniformBlockBinding);
+    }
+
+    void recordUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+    {
+        write(GLUtils::UNIFORM_MATRIX4FV_CALL, location, count, transpose);
+        for (GLsizei i = 0; i < 16 * count; i++)
+            append(value[i]);
+    }
+
+    GLboolean recordUnmapBuffer(GLenum target)
+    {
+        write(GLUtils::UNMAP_BUFFER_CALL, target);
+        return GL_TRUE;
+    }
+
+    void recordUseProgram(GLuint program)
+    {
+        write(GLUtils::USE_PROGRAM_CALL, program);
+    }
+
+    void recordVertexAttribDivisor(GLuint index, GLuint divisor)
+    {
+        write(GLUtils::VERTEX_ATTRIB_DIVISOR_CALL, index, divisor);
+    }
+
+    void recordVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+    {
+        write(GLUtils::VERTEX_ATTRIB_POINTER_CALL, index, size, type, normalized, stride, pointer);
+    }
+
+    void recordViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        write(GLUtils::VIEWPORT_CALL, x, y, width, height);
+    }
+
+    GLUtils::Dispatch native = {
+        &glAttachShader,
+        &glBindBuffer,
+        &glBindBufferRange,
+        &glBindTexture,
+        &glBindVertexArray,
+        &glBufferData,
+        nullptr, // glBufferStorage, GL 4.4: see loadExtensions
+        &glBufferSubData,
+        &glClear,
+        &glClearColor,
+        &glClientWaitSync,
+        &glCompileShader,
+        &glCopyBufferSubData,
+        &glCreateProgram,
+        &glCreateShader,
+        &glDeleteBuffers,
+        &glDeleteProgram,
+        &glDeleteShader,
+        &glDeleteSync,
+        &glDeleteVertexArrays,
+        &glDrawArrays,
+        &glDrawArraysInstanced,
+        &glDrawElements,
+        &glEnableVertexAttribArray,
+        &glFenceSync,
+        &glGenBuffers,
+        &glGenTextures,
+        &glGenVertexArrays,
+        &glGetActiveUniform,
+        &glGetActiveUniformBlockName,
+        &glGetActiveUniformBlockiv,
+        &glGetError,
+        &glGetIntegerv,
+        &glGetProgramBinary,
+        &glGetProgramInfoLog,
+        &glGetProgramiv,
+        &glGetShaderInfoLog,
+        &glGetShaderiv,
+        &glGetString,
+        &glGetUniformBlockIndex,
+        &glGetUniformLocation,
+        &glLinkProgram,
+        &glMapBufferRange,
+        &glMultiDrawElements,
+        &glMultiDrawElementsBaseVertex,
+        &glPolygonMode,
+        &glProgramBinary,
+        &glProgramParameteri,
+        &glProgramUniform1f,
+        &glProgramUniform1i,
+        &glProgramUniform2f,
+        &glProgramUniformMatrix4fv,
+        &glShaderSource,
+        &glTexBuffer,
+        &glUniform1f,
+        &glUniform1i,
+        &glUniform2f,
+        &glUniformBlockBinding,
+        &glUniformMatrix4fv,
+        &glUnmapBuffer,
+        &glUseProgram,
+        &glVertexAttribDivisor,
+        &glVertexAttribPointer,
+        &glViewport,
+    };
+
+    const GLUtils::Dispatch recording = {
+        &recordAttachShader,
+        &recordBindBuffer,
+        &recordBindBufferRange,
+        &recordBindTexture,
+        &recordBindVertexArray,
+        &recordBufferData,
+        &recordBufferStorage,
+        &recordBufferSubData,
+        &recordClear,
+        &recordClearColor,
+        &recordClientWaitSync,
+        &recordCompileShader,
+        &recordCopyBufferSubData,
+        &recordCreateProgram,
+        &recordCreateShader,
+        &recordDeleteBuffers,
+        &recordDeleteProgram,
+        &recordDeleteShader,
+        &recordDeleteSync,
+        &recordDeleteVertexArrays,
+        &recordDrawArrays,
+        &recordDrawArraysInstanced,
+        &recordDrawElements,
+        &recordEnableVertexAttribArray,
+        &recordFenceSync,
+        &recordGenBuffers,
+        &recordGenTextures,
+        &recordGenVertexArrays,
+        &recordGetActiveUniform,
+        &recordGetActiveUniformBlockName,
+        &recordGetActiveUniformBlockiv,
+        &recordGetError,
+        &recordGetIntegerv,
+        &recordGetProgramBinary,
+        &recordGetProgramInfoLog,
+        &recordGetProgramiv,
+        &recordGetShaderInfoLog,
+        &recordGetShaderiv,
+        &recordGetString,
+        &recordGetUniformBlockIndex,
+        &recordGetUniformLocation,
+        &recordLinkProgram,
+        &recordMapBufferRange,
+        &recordMultiDrawElements,
+        &recordMultiDrawElementsBaseVertex,
+        &recordPolygonMode,
+        &recordProgramBinary,
+        &recordProgramParameteri,
+        &recordProgramUniform1f,
+        &recordProgramUniform1i,
+        &recordProgramUniform2f,
+        &recordProgramUniformMatrix4fv,
+        &recordShaderSource,
+        &recordTexBuffer,
+        &recordUniform1f,
+        &recordUniform1i,
+        &recordUniform2f,
+        &recordUniformBlockBinding,
+        &recordUniformMatrix4fv,
+        &recordUnmapBuffer,
+        &recordUseProgram,
+        &recordVertexAttribDivisor,
+        &recordVertexAttribPointer,
+        &recordViewport,
+    };
+
+    const char *const names[GLUtils::CALL_COUNT] = {
+        "glAttachShader",
+        "glBindBuffer",
+        "glBindBufferRange",
+        "glBindTexture",
+        "glBindVertexArray",
+        "glBufferData",
+        "glBufferStorage",
+        "glBufferSubData",
+        "glClear",
+        "glClearColor",
+        "glClientWaitSync",
+        "glCompileShader",
+        "glCopyBufferSubData",
+        "glCreateProgram",
+        "glCreateShader",
+        "glDeleteBuffers",
+        "glDeleteProgram",
+        "glDeleteShader",
+        "glDeleteSync",
+        "glDeleteVertexArrays",
+        "glDrawArrays",
+        "glDrawArraysInstanced",
+        "glDrawElements",
+        "glEnableVertexAttribArray",
+        "glFenceSync",
+        "glGenBuffers",
+        "glGenTextures",
+        "glGenVertexArrays",
+        "glGetActiveUniform",
+        "glGetActiveUniformBlockName",
+        "glGetActiveUniformBlockiv",
+        "glGetError",
+        "glGetIntegerv",
+        "glGetProgramBinary",
+        "glGetProgramInfoLog",
+        "glGetProgramiv",
+        "glGetShaderInfoLog",
+        "glGetShaderiv",
+        "glGetString",
+        "glGetUniformBlockIndex",
+        "glGetUniformLocation",
+        "glLinkProgram",
+        "glMapBufferRange",
+        "glMultiDrawElements",
+        "glMultiDrawElementsBaseVertex",
+        "glPolygonMode",
+        "glProgramBinary",
+        "glProgramParameteri",
+        "glProgramUniform1f",
+        "glProgramUniform1i",
+        "glProgramUniform2f",
+        "glProgramUniformMatrix4fv",
+        "glShaderSource",
+        "glTexBuffer",
+        "glUniform1f",
+        "glUniform1i",
+        "glUniform2f",
+        "glUniformBlockBinding",
+        "glUniformMatrix4fv",
+        "glUnmapBuffer",
+        "glUseProgram",
+        "glVertexAttribDivisor",
+        "glVertexAttribPointer",
+        "glViewport",
+    };
+
+    GLUtils::Dispatch &current()
+    {
+        static GLUtils::Dispatch dispatch = native;
+        return dispatch;
+    }
+}
+
+std::size_t GLUtils::Recorder::totalCalls() const
+{
+    std::size_t total = 0;
+    for (std::size_t count : calls)
+        total += count;
+    return total;
+}
+
+void GLUtils::Recorder::clear()
+{
+    stream.clear();
+    std::fill(calls, calls + CALL_COUNT, 0);
+    uploadedBytes = 0;
+}
+
+const GLUtils::Dispatch &GLUtils::gl()
+{
+    return current();
+}
+
+void GLUtils::setDispatch(const GLUtils::Dispatch &dispatch)
+{
+    current() = dispatch;
+}
+
+const GLUtils::Dispatch &GLUtils::nativeDispatch()
+{
+    return native;
+}
+
+void GLUtils::record(GLUtils::Recorder &target)
+{
+    recorder = &target;
+    current() = recording;
+}
+
+bool GLUtils::supports(int major, int minor, const char *extension)
+{
+    GLint contextMajor = 0;
+    GLint contextMinor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+    if (contextMajor > major || (contextMajor == major && contextMinor >= minor))
+        return true;
+    return GLUtils::hasExtension(extension);
+}
+
+bool GLUtils::hasExtension(const char *extension)
+{
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions; i++)
+        if (std::strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), extension) == 0)
+            return true;
+    return false;
+}
+
+bool GLUtils::loadExtensions(GLUtils::ProcAddress (*getProcAddress)(const char *))
+{
+    const bool bufferStorage = GLUtils::supports(4, 4, "GL_ARB_buffer_storage");
+    native.BufferStorage = bufferStorage ? (void (*)(GLenum, GLsizeiptr, const void *, GLbitfield))getProcAddress("glBufferStorage") : nullptr;
+    // Unless the calls are sent to another backend
+    if (current().AttachShader == native.AttachShader)
+        current().BufferStorage = native.BufferStorage;
+    return native.BufferStorage != nullptr;
+}
+
+const char *GLUtils::callName(GLUtils::Call call)
+{
+    return call < CALL_COUNT ? names[call] : "";
+}
@@ -0,0 +1,118 @@
+#include "Base/headless.h"
+#include "Base/logs.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+std::size_t GLUtils::headlessFrames(int argc, char **argv)
+{
+    for (int i = 1; i + 1 < argc; i++)
+        if (std::strcmp(argv[i], "--headless") == 0)
+            return std::strtoul(argv[i + 1], nullptr, 10);
+    return 0;
+}
+
+bool GLUtils::initHeadless()
+{
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    return glfwInit() == GLFW_TRUE;
+}
+
+GLFWwindow *GLUtils::createHeadlessWindow(int width, int height, const char *title)
+{
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    // The null platform renders through EGL_MESA_platform_surfaceless, or OSMesa
+    for (int api : {GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API})
+    {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+        GLFWwindow *window = glfwCreateWindow(width, height, title, NULL, NULL);
+        if (window)
+        {
+            info("headless context: " << (api == GLFW_EGL_CONTEXT_API ? "EGL" : "OSMesa"));
+            glfwMakeContextCurrent(window);
+            return window;
+        }
+    }
+    error("no headless context: EGL and OSMesa failed");
+    return NULL;
+}
+
+GLUtils::OffscreenTarget::OffscreenTarget(int width, int height)
+    : width(width), height(height)
+{
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+}
+
+GLUtils::OffscreenTarget::~OffscreenTarget()
+{
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color);
+}
+
+bool GLUtils::OffscreenTarget::isComplete() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void GLUtils::OffscreenTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void GLUtils::OffscreenTarget::read(std::vector<uint8_t> &pixels) const
+{
+    pixels.resize((std::size_t)width * height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+uint32_t GLUtils::OffscreenTarget::checksum() const
+{
+    std::vector<uint8_t> pixels;
+    read(pixels);
+    uint32_t hash = 2166136261u;
+    for (uint8_t byte : pixels)
+        hash = (hash ^ byte) * 16777619u;
+    return hash;
+}
+
+void GLUtils::FrameTimes::begin()
+{
+    start = std::chrono::steady_clock::now();
+}
+
+void GLUtils::FrameTimes::end()
+{
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    frames.push_back(elapsed.count());
+}
+
+std::size_t GLUtils::FrameTimes::getCount() const
+{
+    return frames.size();
+}
+
+void GLUtils::FrameTimes::report(const char *name) const
+{
+    if (frames.empty())
+        return;
+    std::vector<double> sorted = frames;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double frame : frames)
+        total += frame;
+    const double mean = total / frames.size();
+    info(name << ": " << frames.size() << " frames, " << frames.size() / total << " fps, " << mean * 1e3 << " ms mean, "
+              << sorted[sorted.size() / 2] * 1e3 << " ms median, " << sorted[(sorted.size() - 1) * 99 / 100] * 1e3 << " ms p99, "
+              << sorted.back() * 1e3 << " ms max");
+}
@@ -0,0 +1,93 @@
+#include "Base/line_batch.h"
+#include "Base/maths_utils.h"
+#include <algorithm>
+
+namespace
+{
+    /*
+     * The points [first, last) of one polyline, and the arc length of the point first.
+     */
+    struct Piece
+    {
+        std::size_t polyline;
+        std::size_t first;
+        std::size_t last;
+        float distance;
+    };
+
+    /*
+     * Expands the piece and writes the indices of the segments starting in it.
+     */
+    void tessellatePiece(const LineUtils::PolylineView &polyline, const LineUtils::BatchRange &range, const Piece &piece, LineUtils::Batch &batch)
+    {
+        LineUtils::expandRange(polyline.points, polyline.count, piece.first, piece.last, piece.distance, &batch.vertices[range.firstVertex + 2 * piece.first]);
+
+        const std::size_t lastSegment = std::min(piece.last, polyline.count - 1);
+        if (lastSegment > piece.first)
+            MathsUtils::writeIndices(lastSegment - piece.first, range.firstVertex + 2 * piece.first, &batch.indices[range.firstIndex + 6 * piece.first]);
+    }
+}
+
+void LineUtils::tessellateBatch(const LineUtils::PolylineView *polylines, std::size_t count, ThreadUtils::ThreadPool &pool, LineUtils::Batch &batch, std::size_t chunkPoints)
+{
+    chunkPoints = std::max<std::size_t>(chunkPoints, 1);
+
+    // Prefix sum of the vertex and index counts
+    batch.ranges.resize(count);
+    std::size_t vertices = 0, indices = 0;
+    for (std::size_t l = 0; l < count; l++)
+    {
+        const std::size_t points = polylines[l].count;
+        batch.ranges[l] = {vertices, 2 * points, indices, points > 1 ? 6 * (points - 1) : 0};
+        vertices += batch.ranges[l].vertexCount;
+        indices += batch.ranges[l].indexCount;
+    }
+    batch.vertices.resize(vertices);
+    batch.indices.resize(indices);
+
+    // Cut the work into tasks of about chunkPoints points
+    std::vector<Piece> pieces;
+    std::vector<std::size_t> tasks{0};
+    std::size_t load = 0;
+    for (std::size_t l = 0; l < count; l++)
+    {
+        for (std::size_t first = 0; first < polylines[l].count; first += chunkPoints)
+        {
+            const std::size_t last = std::min(polylines[l].count, first + chunkPoints);
+            pieces.push_back({l, first, last, 0.0f});
+            load += last - first;
+            if (load >= chunkPoints)
+            {
+                tasks.push_back(pieces.size());
+                load = 0;
+            }
+        }
+    }
+    if (tasks.back() != pieces.size())
+        tasks.push_back(pieces.size());
+
+    // The arc length of each piece, then their prefix sum along each polyline
+    std::vector<float> lengths(pieces.size());
+    for (std::size_t t = 0; t + 1 < tasks.size(); t++)
+    {
+        const std::size_t begin = tasks[t], end = tasks[t + 1];
+        pool.submit([&, begin, end]()
+                    {
+            for (std::size_t p = begin; p < end; p++)
+                lengths[p] = LineUtils::arcLength(polylines[pieces[p].polyline].points, pieces[p].first, std::min(pieces[p].last, polylines[pieces[p].polyline].count - 1)); });
+    }
+    pool.wait();
+    for (std::size_t p = 1; p < pieces.size(); p++)
+        if (pieces[p].first > 0)
+            pieces[p].distance = pieces[p - 1].distance + lengths[p - 1];
+
+    for (std::size_t t = 0; t + 1 < tasks.size(); t++)
+    {
+        const std::size_t begin = tasks[t], end = tasks[t + 1];
+        pool.submit([&, begin, end]()
+                    {
+            for (std::size_t p = begin; p < end; p++)
+                tessellatePiece(polylines[pieces[p].polyline], batch.ranges[pieces[p].polyline], pieces[p], batch); });
+    }
+    pool.wait();
+}
@@ -0,0 +1,63 @@
+#include "Base/line_chunks.h"
+#include <algorithm>
+
+void LineUtils::ChunkedLine::build(const glm::vec3 *points, std::size_t count, std::size_t chunkSegments, const uint32_t *segmentIndices)
+{
+    chunks.clear();
+    chunkSegments = std::max<std::size_t>(chunkSegments, 1);
+    const std::size_t segments = count > 1 ? count - 1 : 0;
+    for (std::size_t first = 0; first < segments; first += chunkSegments)
+    {
+        LineChunk chunk;
+        chunk.firstSegment = first;
+        chunk.segmentCount = std::min(chunkSegments, segments - first);
+        const std::size_t last = first + chunk.segmentCount;
+        chunk.firstIndex = segmentIndices ? segmentIndices[first] : first * 6;
+        chunk.indexCount = (segmentIndices ? segmentIndices[last] : last * 6) - chunk.firstIndex;
+        // The points of the segments [first, first + segmentCount)
+        chunk.boundsMin = chunk.boundsMax = points[first];
+        for (std::size_t i = first + 1; i <= first + chunk.segmentCount; i++)
+        {
+            chunk.boundsMin = glm::min(chunk.boundsMin, points[i]);
+            chunk.boundsMax = glm::max(chunk.boundsMax, points[i]);
+        }
+        chunks.push_back(chunk);
+    }
+}
+
+GLsizei LineUtils::ChunkedLine::cull(const glm::mat4 &projViewModel, float margin, GLenum indexType, std::vector<GLsizei> &counts, std::vector<const void *> &offsets) const
+{
+    counts.clear();
+    offsets.clear();
+    const std::size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    const MathsUtils::Frustum frustum = MathsUtils::frustumFromMatrix(projViewModel, margin);
+
+    bool extending = false;
+    for (const LineChunk &chunk : chunks)
+    {
+        // Empty chunks, made of repeated points, don't break a range
+        if (chunk.indexCount == 0)
+            continue;
+        if (!MathsUtils::intersects(frustum, chunk.boundsMin, chunk.boundsMax))
+        {
+            extending = false;
+            continue;
+        }
+        if (extending)
+        {
+            counts.back() += (GLsizei)chunk.indexCount;
+        }
+        else
+        {
+            counts.push_back((GLsizei)chunk.indexCount);
+            offsets.push_back((const void *)(chunk.firstIndex * indexSize));
+        }
+        extending = true;
+    }
+    return (GLsizei)counts.size();
+}
+
+const std::vector<LineUtils::LineChunk> &LineUtils::ChunkedLine::getChunks() const
+{
+    return chunks;
+}
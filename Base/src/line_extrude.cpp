@@ -0,0 +1,280 @@
+#include "Base/line_extrude.h"
+#include "../../glm/glm/simd/platform.h"
+#include <cmath>
+
+namespace
+{
+
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+    /*
+     * 8 lanes, AVX2.
+     */
+    struct Lanes
+    {
+        typedef __m256 Float;
+        typedef __m256 Mask;
+        static const int WIDTH = 8;
+        static const char *name() { return "avx2"; }
+
+        static Float load(const float *p) { return _mm256_load_ps(p); }
+        static void store(float *p, Float a) { _mm256_store_ps(p, a); }
+        static Float set(float a) { return _mm256_set1_ps(a); }
+        static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+        static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+        static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+        static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+        static Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+        static Mask equal(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+        static Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+        static Mask either(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+        static Float select(Mask m, Float a, Float b) { return _mm256_blendv_ps(b, a, m); }
+    };
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+    /*
+     * 4 lanes, SSE2, with the SSE4.1 blend when available.
+     */
+    struct Lanes
+    {
+        typedef __m128 Float;
+        typedef __m128 Mask;
+        static const int WIDTH = 4;
+        static const char *name() { return "sse"; }
+
+        static Float load(const float *p) { return _mm_load_ps(p); }
+        static void store(float *p, Float a) { _mm_store_ps(p, a); }
+        static Float set(float a) { return _mm_set1_ps(a); }
+        static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+        static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+        static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+        static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+        static Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+        static Mask equal(Float a, Float b) { return _mm_cmpeq_ps(a, b); }
+        static Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+        static Mask either(Mask a, Mask b) { return _mm_or_ps(a, b); }
+#if GLM_ARCH & GLM_ARCH_SSE41_BIT
+        static Float select(Mask m, Float a, Float b) { return _mm_blendv_ps(b, a, m); }
+#else
+        static Float select(Mask m, Float a, Float b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+#endif
+    };
+#elif (GLM_ARCH & GLM_ARCH_NEON_BIT) && (GLM_ARCH & GLM_ARCH_ARMV8_BIT)
+    /*
+     * 4 lanes, NEON. ARMv8 only: ARMv7 has neither a vector division nor a square root.
+     */
+    struct Lanes
+    {
+        typedef float32x4_t Float;
+        typedef uint32x4_t Mask;
+        static const int WIDTH = 4;
+        static const char *name() { return "neon"; }
+
+        static Float load(const float *p) { return vld1q_f32(p); }
+        static void store(float *p, Float a) { vst1q_f32(p, a); }
+        static Float set(float a) { return vdupq_n_f32(a); }
+        static Float add(Float a, Float b) { return vaddq_f32(a, b); }
+        static Float sub(Float a, Float b) { return vsubq_f32(a, b); }
+        static Float mul(Float a, Float b) { return vmulq_f32(a, b); }
+        static Float div(Float a, Float b) { return vdivq_f32(a, b); }
+        static Float sqrt(Float a) { return vsqrtq_f32(a); }
+        static Mask equal(Float a, Float b) { return vceqq_f32(a, b); }
+        static Mask both(Mask a, Mask b) { return vandq_u32(a, b); }
+        static Mask either(Mask a, Mask b) { return vorrq_u32(a, b); }
+        static Float select(Mask m, Float a, Float b) { return vbslq_f32(m, a, b); }
+    };
+#else
+#define LINE_EXTRUDE_SCALAR
+#endif
+
+#ifndef LINE_EXTRUDE_SCALAR
+    /*
+     * Processes the vertices by blocks of Lanes::WIDTH, and returns how many have been processed.
+     * Each lane goes through every branch of the shader, the right one is selected at the end.
+     */
+    std::size_t extrudeLanes(const LineUtils::LineVertex *vertices, std::size_t count, const LineUtils::ExtrudeParams &params, glm::vec4 *out)
+    {
+        typedef Lanes::Float Float;
+        typedef Lanes::Mask Mask;
+        const int W = Lanes::WIDTH;
+
+        Float m[4][4];
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                m[column][row] = Lanes::set(params.projViewModel[column][row]);
+        const Float aspect = Lanes::set(params.aspect);
+        const Float thickness = Lanes::set(params.thickness);
+        const Float half = Lanes::set(0.5f);
+        const Float one = Lanes::set(1.0f);
+        const Float zero = Lanes::set(0.0f);
+
+        auto project = [&](int row, Float x, Float y, Float z)
+        {
+            return Lanes::add(Lanes::add(Lanes::mul(m[0][row], x), Lanes::mul(m[1][row], y)),
+                              Lanes::add(Lanes::mul(m[2][row], z), m[3][row]));
+        };
+        // Same operations, in the same order, as glm::normalize: v * inversesqrt(dot(v, v))
+        auto normalize = [&](Float &x, Float &y)
+        {
+            Float inverse = Lanes::div(one, Lanes::sqrt(Lanes::add(Lanes::mul(x, x), Lanes::mul(y, y))));
+            x = Lanes::mul(x, inverse);
+            y = Lanes::mul(y, inverse);
+        };
+
+        // Structure of arrays: position, direction, next, previous
+        alignas(32) float in[10][W];
+        alignas(32) float res[4][W];
+
+        std::size_t i = 0;
+        for (; i + W <= count; i += W)
+        {
+            for (int l = 0; l < W; l++)
+            {
+                const LineUtils::LineVertex &v = vertices[i + l];
+                in[0][l] = v.position.x;
+                in[1][l] = v.position.y;
+                in[2][l] = v.position.z;
+                in[3][l] = v.direction;
+                in[4][l] = v.next.x;
+                in[5][l] = v.next.y;
+                in[6][l] = v.next.z;
+                in[7][l] = v.previous.x;
+                in[8][l] = v.previous.y;
+                in[9][l] = v.previous.z;
+            }
+            Float px = Lanes::load(in[0]), py = Lanes::load(in[1]), pz = Lanes::load(in[2]);
+            Float nx = Lanes::load(in[4]), ny = Lanes::load(in[5]), nz = Lanes::load(in[6]);
+            Float qx = Lanes::load(in[7]), qy = Lanes::load(in[8]), qz = Lanes::load(in[9]);
+            Float orientation = Lanes::load(in[3]);
+
+            Float currentX = project(0, px, py, pz);
+            Float currentY = project(1, px, py, pz);
+            Float currentZ = project(2, px, py, pz);
+            Float currentW = project(3, px, py, pz);
+
+            // 2D screen space with W divide and aspect correction
+            Float currentScreenX = Lanes::mul(Lanes::div(currentX, currentW), aspect);
+            Float currentScreenY = Lanes::div(currentY, currentW);
+            Float nextW = project(3, nx, ny, nz);
+            Float nextScreenX = Lanes::mul(Lanes::div(project(0, nx, ny, nz), nextW), aspect);
+            Float nextScreenY = Lanes::div(project(1, nx, ny, nz), nextW);
+            Float previousW = project(3, qx, qy, qz);
+            Float previousScreenX = Lanes::mul(Lanes::div(project(0, qx, qy, qz), previousW), aspect);
+            Float previousScreenY = Lanes::div(project(1, qx, qy, qz), previousW);
+
+            Mask isStart = Lanes::both(Lanes::equal(currentScreenX, previousScreenX), Lanes::equal(currentScreenY, previousScreenY));
+            Mask isEnd = Lanes::both(Lanes::equal(currentScreenX, nextScreenX), Lanes::equal(currentScreenY, nextScreenY));
+
+            // (next - current), used by the starting point and as dirB
+            Float dirBX = Lanes::sub(nextScreenX, currentScreenX);
+            Float dirBY = Lanes::sub(nextScreenY, currentScreenY);
+            normalize(dirBX, dirBY);
+            // (current - previous), used by the ending point and as dirA
+            Float dirAX = Lanes::sub(currentScreenX, previousScreenX);
+            Float dirAY = Lanes::sub(currentScreenY, previousScreenY);
+            normalize(dirAX, dirAY);
+
+            Float joinX = dirAX, joinY = dirAY;
+            Float len = thickness;
+            if (params.miter)
+            {
+                joinX = Lanes::add(dirAX, dirBX);
+                joinY = Lanes::add(dirAY, dirBY);
+                normalize(joinX, joinY);
+                // dot(miter, perp) = dot((-tangent.y, tangent.x), (-dirA.y, dirA.x))
+                Float dot = Lanes::add(Lanes::mul(joinY, dirAY), Lanes::mul(joinX, dirAX));
+                Mask isJoin = Lanes::either(isStart, isEnd);
+                len = Lanes::select(isJoin, thickness, Lanes::div(thickness, dot));
+            }
+            Float dirX = Lanes::select(isStart, dirBX, Lanes::select(isEnd, dirAX, joinX));
+            Float dirY = Lanes::select(isStart, dirBY, Lanes::select(isEnd, dirAY, joinY));
+
+            Float halfLen = Lanes::mul(len, half);
+            Float normalX = Lanes::div(Lanes::mul(Lanes::sub(zero, dirY), halfLen), aspect);
+            Float normalY = Lanes::mul(dirX, halfLen);
+            normalX = Lanes::mul(normalX, orientation);
+            normalY = Lanes::mul(normalY, orientation);
+
+            Lanes::store(res[0], Lanes::add(currentX, normalX));
+            Lanes::store(res[1], Lanes::add(currentY, normalY));
+            Lanes::store(res[2], currentZ);
+            Lanes::store(res[3], Lanes::add(currentW, one));
+            for (int l = 0; l < W; l++)
+                out[i + l] = glm::vec4(res[0][l], res[1][l], res[2][l], res[3][l]);
+        }
+        return i;
+    }
+#endif
+}
+
+void LineUtils::extrude(const LineUtils::LineVertex *vertices, std::size_t count, const LineUtils::ExtrudeParams &params, glm::vec4 *out)
+{
+#ifdef LINE_EXTRUDE_SCALAR
+    LineUtils::extrudeReference(vertices, count, params, out);
+#else
+    std::size_t done = extrudeLanes(vertices, count, params, out);
+    LineUtils::extrudeReference(vertices + done, count - done, params, out + done);
+#endif
+}
+
+void LineUtils::extrudeReference(const LineUtils::LineVertex *vertices, std::size_t count, const LineUtils::ExtrudeParams &params, glm::vec4 *out)
+{
+    const glm::vec2 aspectVec(params.aspect, 1.0f);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const LineUtils::LineVertex &vertex = vertices[i];
+        glm::vec4 previousProjected = params.projViewModel * glm::vec4(vertex.previous, 1.0f);
+        glm::vec4 currentProjected = params.projViewModel * glm::vec4(vertex.position, 1.0f);
+        glm::vec4 nextProjected = params.projViewModel * glm::vec4(vertex.next, 1.0f);
+
+        // get 2D screen space with W divide and aspect correction
+        glm::vec2 currentScreen = glm::vec2(currentProjected) / currentProjected.w * aspectVec;
+        glm::vec2 previousScreen = glm::vec2(previousProjected) / previousProjected.w * aspectVec;
+        glm::vec2 nextScreen = glm::vec2(nextProjected) / nextProjected.w * aspectVec;
+
+        float len = params.thickness;
+        float orientation = vertex.direction;
+
+        glm::vec2 dir(0.0f);
+        // starting point uses (next - current)
+        if (currentScreen == previousScreen)
+        {
+            dir = glm::normalize(nextScreen - currentScreen);
+        }
+        // ending point uses (current - previous)
+        else if (currentScreen == nextScreen)
+        {
+            dir = glm::normalize(currentScreen - previousScreen);
+        }
+        // somewhere in middle, needs a join
+        else
+        {
+            glm::vec2 dirA = glm::normalize(currentScreen - previousScreen);
+            if (params.miter)
+            {
+                glm::vec2 dirB = glm::normalize(nextScreen - currentScreen);
+                glm::vec2 tangent = glm::normalize(dirA + dirB);
+                glm::vec2 perp(-dirA.y, dirA.x);
+                glm::vec2 miter(-tangent.y, tangent.x);
+                dir = tangent;
+                len = params.thickness / glm::dot(miter, perp);
+            }
+            else
+            {
+                dir = dirA;
+            }
+        }
+        glm::vec2 normal(-dir.y, dir.x);
+        normal *= len / 2.0f;
+        normal.x /= params.aspect;
+
+        out[i] = currentProjected + glm::vec4(normal * orientation, 0.0f, 1.0f);
+    }
+}
+
+const char *LineUtils::extrudeArch()
+{
+#ifdef LINE_EXTRUDE_SCALAR
+    return "scalar";
+#else
+    return Lanes::name();
+#endif
+}
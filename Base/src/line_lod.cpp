@@ -0,0 +1,149 @@
+#include "Base/line_lod.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    /*
+     * Distance between p and the segment [a, b].
+     */
+    float segmentDistance(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b)
+    {
+        glm::vec3 ab = b - a;
+        float length2 = glm::dot(ab, ab);
+        float t = length2 > 0.0f ? glm::clamp(glm::dot(p - a, ab) / length2, 0.0f, 1.0f) : 0.0f;
+        return glm::length(p - (a + t * ab));
+    }
+
+    /*
+     * Segment [first, last] of the polyline, and the significance of the point which split its parent.
+     */
+    struct Span
+    {
+        std::size_t first;
+        std::size_t last;
+        float parent;
+    };
+}
+
+std::vector<float> LineUtils::simplificationErrors(const glm::vec3 *points, std::size_t count)
+{
+    std::vector<float> errors(count, 0.0f);
+    if (count == 0)
+        return errors;
+    errors.front() = errors.back() = std::numeric_limits<float>::infinity();
+
+    // Iterative, long polylines would overflow the call stack. Douglas-Peucker is quadratic
+    // on periodic signals, so the polyline is first cut in spans whose ends are always kept.
+    std::vector<Span> stack;
+    for (std::size_t first = 0; first + 2 < count; first += LineUtils::LOD_SPAN_POINTS)
+    {
+        std::size_t last = std::min(first + LineUtils::LOD_SPAN_POINTS, count - 1);
+        errors[last] = std::numeric_limits<float>::infinity();
+        stack.push_back({first, last, std::numeric_limits<float>::infinity()});
+    }
+    while (!stack.empty())
+    {
+        Span span = stack.back();
+        stack.pop_back();
+
+        std::size_t farthest = span.first + 1;
+        float distance = -1.0f;
+        for (std::size_t i = span.first + 1; i < span.last; i++)
+        {
+            float d = segmentDistance(points[i], points[span.first], points[span.last]);
+            if (d > distance)
+            {
+                distance = d;
+                farthest = i;
+            }
+        }
+        float error = std::min(distance, span.parent);
+        errors[farthest] = error;
+        if (farthest - span.first > 1)
+            stack.push_back({span.first, farthest, error});
+        if (span.last - farthest > 1)
+            stack.push_back({farthest, span.last, error});
+    }
+    return errors;
+}
+
+void LineUtils::LodHierarchy::build(const glm::vec3 *points, std::size_t count, std::size_t maxLevels)
+{
+    levels.clear();
+    levels.push_back({0.0f, std::vector<glm::vec3>(points, points + count)});
+    if (count == 0)
+        return;
+
+    boundsMin = boundsMax = points[0];
+    for (std::size_t i = 1; i < count; i++)
+    {
+        boundsMin = glm::min(boundsMin, points[i]);
+        boundsMax = glm::max(boundsMax, points[i]);
+    }
+
+    std::vector<float> errors = LineUtils::simplificationErrors(points, count);
+    float smallest = std::numeric_limits<float>::infinity();
+    for (float error : errors)
+        if (error > 0.0f)
+            smallest = std::min(smallest, error);
+
+    // From the finest tolerance to the coarsest one, so each level only drops points
+    std::vector<float> tolerances;
+    for (float tolerance = glm::length(boundsMax - boundsMin); tolerance >= smallest && tolerances.size() + 1 < maxLevels; tolerance *= 0.5f)
+        tolerances.push_back(tolerance);
+    std::reverse(tolerances.begin(), tolerances.end());
+
+    for (float tolerance : tolerances)
+    {
+        LodLevel level;
+        level.error = tolerance;
+        for (std::size_t i = 0; i < count; i++)
+            if (errors[i] > tolerance)
+                level.points.push_back(points[i]);
+        if (level.points.size() < levels.back().points.size())
+            levels.push_back(std::move(level));
+    }
+}
+
+std::size_t LineUtils::LodHierarchy::selectLevel(const glm::mat4 &projViewModel, const glm::vec2 &viewport, float maxPixelError) const
+{
+    // Largest number of pixels covered by one model unit, at the corners of the bounding box
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const float step = std::max(glm::length(extent), 1e-6f) * 1e-3f;
+    float pixelsPerUnit = 0.0f;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec3 c = boundsMin + extent * glm::vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+        glm::vec4 origin = projViewModel * glm::vec4(c, 1.0f);
+        if (origin.w <= 0.0f)
+            return 0;
+        glm::vec2 originScreen = glm::vec2(origin) / origin.w * 0.5f * viewport;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            glm::vec3 moved = c;
+            moved[axis] += step;
+            glm::vec4 projected = projViewModel * glm::vec4(moved, 1.0f);
+            if (projected.w <= 0.0f)
+                return 0;
+            glm::vec2 screen = glm::vec2(projected) / projected.w * 0.5f * viewport;
+            pixelsPerUnit = std::max(pixelsPerUnit, glm::length(screen - originScreen) / step);
+        }
+    }
+
+    std::size_t selected = 0;
+    for (std::size_t level = 1; level < levels.size(); level++)
+        if (levels[level].error * pixelsPerUnit <= maxPixelError)
+            selected = level;
+    return selected;
+}
+
+const LineUtils::LodLevel &LineUtils::LodHierarchy::getLevel(std::size_t level) const
+{
+    return levels[level];
+}
+
+std::size_t LineUtils::LodHierarchy::getLevelCount() const
+{
+    return levels.size();
+}
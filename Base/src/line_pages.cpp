@@ -0,0 +1,79 @@
+#include "Base/line_pages.h"
+#include "Base/gl_dispatch.h"
+#include <algorithm>
+
+LineUtils::LinePages::LinePages() {}
+
+LineUtils::LinePages::~LinePages()
+{
+    if (buffer)
+        GLUtils::gl().DeleteBuffers(1, &buffer);
+}
+
+std::size_t LineUtils::LinePages::add(const glm::vec4 *linePoints, std::size_t count)
+{
+    draws.emplace_back();
+    std::vector<PageDraw> &lineDraws = draws.back();
+
+    // w carries the arc length, for the dash patterns
+    std::vector<glm::vec4> measured(linePoints, linePoints + count);
+    float distance = 0.0f;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (i > 0)
+            distance += glm::length(glm::vec3(linePoints[i]) - glm::vec3(linePoints[i - 1]));
+        measured[i].w = distance;
+    }
+
+    // Each piece draws its points [1, size - 2) as segments, so consecutive pieces share 3 points
+    std::size_t first = 0;
+    while (count >= 4 && first + 3 < count)
+    {
+        // A piece never straddles two pages: if it doesn't fit in what's left, open a new one
+        const std::size_t size = std::min(count - first, LINE_PAGE_VERTICES);
+        if (used + size > LINE_PAGE_VERTICES)
+        {
+            points.resize(points.size() + LINE_PAGE_VERTICES, glm::vec4(0.0f));
+            used = 0;
+        }
+
+        const std::size_t page = points.size() / LINE_PAGE_VERTICES - 1;
+        std::copy(measured.begin() + first, measured.begin() + first + size, points.begin() + page * LINE_PAGE_VERTICES + used);
+        lineDraws.push_back({page, (GLint)used, (GLsizei)(6 * (size - 3))});
+
+        used += size;
+        first += size - 3;
+    }
+    return draws.size() - 1;
+}
+
+void LineUtils::LinePages::upload()
+{
+    GLint alignment = 256;
+    GLUtils::gl().GetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    const GLintptr pageSize = LINE_PAGE_VERTICES * sizeof(glm::vec4);
+    pageStride = (pageSize + alignment - 1) / alignment * alignment;
+
+    if (!buffer)
+        GLUtils::gl().GenBuffers(1, &buffer);
+    GLUtils::gl().BindBuffer(GL_UNIFORM_BUFFER, buffer);
+    GLUtils::gl().BufferData(GL_UNIFORM_BUFFER, getPageCount() * pageStride, NULL, GL_STATIC_DRAW);
+    for (std::size_t page = 0; page < getPageCount(); page++)
+        GLUtils::gl().BufferSubData(GL_UNIFORM_BUFFER, page * pageStride, pageSize, &points[page * LINE_PAGE_VERTICES]);
+    GLUtils::gl().BindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void LineUtils::LinePages::bindPage(std::size_t page, GLuint binding) const
+{
+    GLUtils::gl().BindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, page * pageStride, LINE_PAGE_VERTICES * sizeof(glm::vec4));
+}
+
+const std::vector<LineUtils::PageDraw> &LineUtils::LinePages::getDraws(std::size_t line) const
+{
+    return draws[line];
+}
+
+std::size_t LineUtils::LinePages::getPageCount() const
+{
+    return points.size() / LINE_PAGE_VERTICES;
+}
@@ -0,0 +1,221 @@
+#include "Base/line_pool.h"
+#include "Base/gl_dispatch.h"
+#include "Base/maths_utils.h"
+#include <algorithm>
+
+namespace
+{
+    /*
+     * Takes count elements from the first free range large enough. Returns false if none is.
+     */
+    template <typename Range>
+    bool allocate(std::vector<Range> &free, std::size_t count, std::size_t &first)
+    {
+        for (std::size_t i = 0; i < free.size(); i++)
+        {
+            if (free[i].count < count)
+                continue;
+            first = free[i].first;
+            free[i].first += count;
+            free[i].count -= count;
+            if (free[i].count == 0)
+                free.erase(free.begin() + i);
+            return true;
+        }
+        return false;
+    }
+
+    /*
+     * Gives a range back, merged with its free neighbours.
+     */
+    template <typename Range>
+    void release(std::vector<Range> &free, Range range)
+    {
+        if (range.count == 0)
+            return;
+        auto next = std::lower_bound(free.begin(), free.end(), range, [](const Range &a, const Range &b)
+                                     { return a.first < b.first; });
+        next = free.insert(next, range);
+        if (next + 1 != free.end() && next->first + next->count == (next + 1)->first)
+        {
+            next->count += (next + 1)->count;
+            free.erase(next + 1);
+        }
+        if (next != free.begin() && (next - 1)->first + (next - 1)->count == next->first)
+        {
+            (next - 1)->count += next->count;
+            free.erase(next);
+        }
+    }
+
+    /*
+     * Allocates count elements, growing the storage geometrically if no free range is large enough.
+     */
+    template <typename Range, typename Element>
+    std::size_t allocateOrGrow(std::vector<Element> &storage, std::vector<Range> &free, std::size_t count)
+    {
+        std::size_t first = 0;
+        if (count == 0 || allocate(free, count, first))
+            return first;
+        const std::size_t size = storage.size();
+        storage.resize(std::max(size * 2, size + count));
+        release(free, Range{size, storage.size() - size});
+        allocate(free, count, first);
+        return first;
+    }
+
+    /*
+     * Extends the range [begin, end) to cover [first, last).
+     */
+    void markDirty(std::size_t &begin, std::size_t &end, std::size_t first, std::size_t last)
+    {
+        if (first == last)
+            return;
+        if (begin == end)
+            begin = first;
+        begin = std::min(begin, first);
+        end = std::max(end, last);
+    }
+}
+
+void LineUtils::PoolDrawList::clear()
+{
+    counts.clear();
+    offsets.clear();
+    baseVertices.clear();
+}
+
+GLsizei LineUtils::PoolDrawList::size() const
+{
+    return (GLsizei)counts.size();
+}
+
+LineUtils::LinePool::LinePool() {}
+
+LineUtils::LinePool::~LinePool()
+{
+    if (vertexBuffer)
+        GLUtils::gl().DeleteBuffers(1, &vertexBuffer);
+    if (indexBuffer)
+        GLUtils::gl().DeleteBuffers(1, &indexBuffer);
+}
+
+std::size_t LineUtils::LinePool::add(const LineVertex *lineVertices, std::size_t vertexCount, const uint32_t *lineIndices, std::size_t indexCount)
+{
+    Slot slot;
+    slot.vertices = {allocateOrGrow(vertices, freeVertices, vertexCount), vertexCount};
+    slot.indices = {allocateOrGrow(indices, freeIndices, indexCount), indexCount};
+    slot.live = true;
+    std::copy(lineVertices, lineVertices + vertexCount, vertices.begin() + slot.vertices.first);
+    std::copy(lineIndices, lineIndices + indexCount, indices.begin() + slot.indices.first);
+    markDirty(dirtyVertexBegin, dirtyVertexEnd, slot.vertices.first, slot.vertices.first + vertexCount);
+    markDirty(dirtyIndexBegin, dirtyIndexEnd, slot.indices.first, slot.indices.first + indexCount);
+
+    if (freeSlots.empty())
+    {
+        lines.push_back(slot);
+        return lines.size() - 1;
+    }
+    const std::size_t line = freeSlots.back();
+    freeSlots.pop_back();
+    lines[line] = slot;
+    return line;
+}
+
+std::size_t LineUtils::LinePool::addPolyline(const glm::vec3 *points, std::size_t count)
+{
+    std::vector<LineVertex> expanded(LineUtils::expandedSize(count));
+    LineUtils::expand(points, count, expanded.data());
+    const std::vector<uint32_t> segments = MathsUtils::createIndices32(count);
+    return add(expanded.data(), expanded.size(), segments.data(), segments.size());
+}
+
+void LineUtils::LinePool::remove(std::size_t line)
+{
+    if (line >= lines.size() || !lines[line].live)
+        return;
+    // The content of the ranges is left as is: nothing draws it
+    release(freeVertices, lines[line].vertices);
+    release(freeIndices, lines[line].indices);
+    lines[line].live = false;
+    freeSlots.push_back(line);
+}
+
+std::size_t LineUtils::LinePool::upload()
+{
+    std::size_t uploaded = 0;
+    if (!vertexBuffer)
+        GLUtils::gl().GenBuffers(1, &vertexBuffer);
+    if (!indexBuffer)
+        GLUtils::gl().GenBuffers(1, &indexBuffer);
+
+    if (dirtyVertexBegin != dirtyVertexEnd)
+    {
+        GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        if (vertices.size() > vertexCapacity)
+        {
+            // Same buffer ID: the attribute bindings of the VAOs stay valid
+            vertexCapacity = vertices.size();
+            GLUtils::gl().BufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(LineVertex), NULL, GL_DYNAMIC_DRAW);
+            dirtyVertexBegin = 0;
+            dirtyVertexEnd = vertices.size();
+        }
+        const std::size_t size = (dirtyVertexEnd - dirtyVertexBegin) * sizeof(LineVertex);
+        GLUtils::gl().BufferSubData(GL_ARRAY_BUFFER, dirtyVertexBegin * sizeof(LineVertex), size, &vertices[dirtyVertexBegin]);
+        GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, 0);
+        uploaded += size;
+        dirtyVertexBegin = dirtyVertexEnd = 0;
+    }
+
+    if (dirtyIndexBegin != dirtyIndexEnd)
+    {
+        // The element array binding is part of the VAO state, so we don't unbind it
+        // from a VAO which may be bound: copy through GL_COPY_WRITE_BUFFER instead
+        GLUtils::gl().BindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+        if (indices.size() > indexCapacity)
+        {
+            indexCapacity = indices.size();
+            GLUtils::gl().BufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(uint32_t), NULL, GL_DYNAMIC_DRAW);
+            dirtyIndexBegin = 0;
+            dirtyIndexEnd = indices.size();
+        }
+        const std::size_t size = (dirtyIndexEnd - dirtyIndexBegin) * sizeof(uint32_t);
+        GLUtils::gl().BufferSubData(GL_COPY_WRITE_BUFFER, dirtyIndexBegin * sizeof(uint32_t), size, &indices[dirtyIndexBegin]);
+        GLUtils::gl().BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        uploaded += size;
+        dirtyIndexBegin = dirtyIndexEnd = 0;
+    }
+    return uploaded;
+}
+
+void LineUtils::LinePool::appendDraw(std::size_t line, PoolDrawList &list) const
+{
+    const Slot &slot = lines[line];
+    if (!slot.live || slot.indices.count == 0)
+        return;
+    list.counts.push_back((GLsizei)slot.indices.count);
+    list.offsets.push_back((const void *)(slot.indices.first * sizeof(uint32_t)));
+    list.baseVertices.push_back((GLint)slot.vertices.first);
+}
+
+void LineUtils::LinePool::drawAll(PoolDrawList &list) const
+{
+    list.clear();
+    for (std::size_t line = 0; line < lines.size(); line++)
+        appendDraw(line, list);
+}
+
+GLuint LineUtils::LinePool::getVertexBuffer() const
+{
+    return vertexBuffer;
+}
+
+GLuint LineUtils::LinePool::getIndexBuffer() const
+{
+    return indexBuffer;
+}
+
+std::size_t LineUtils::LinePool::getLineCount() const
+{
+    return lines.size() - freeSlots.size();
+}
@@ -0,0 +1,124 @@
+#include "Base/line_quantize.h"
+#include "Base/maths_utils.h"
+#include "../../glm/glm/gtc/packing.hpp"
+#include "../../glm/glm/gtc/matrix_transform.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /*
+     * The most segments of a chunk whose aliased vertices fit 16-bit indices.
+     */
+    const std::size_t MAX_QUANTIZED_CHUNK_SEGMENTS = (MathsUtils::MAX_UNSIGNED_SHORT_VERTICES - 2 * LineUtils::ALIASED_LINE_PADDING) / 2 - 1;
+
+    uint64_t pack(LineUtils::QuantizedFormat format, const glm::vec4 &v)
+    {
+        return format == LineUtils::HALF_FORMAT ? glm::packHalf4x16(v) : glm::packSnorm4x16(v);
+    }
+
+    glm::vec4 unpack(LineUtils::QuantizedFormat format, uint64_t packed)
+    {
+        return format == LineUtils::HALF_FORMAT ? glm::unpackHalf4x16(packed) : glm::unpackSnorm4x16(packed);
+    }
+}
+
+void LineUtils::quantize(const glm::vec3 *points, std::size_t count, LineUtils::QuantizedFormat format, std::size_t chunkSegments, LineUtils::QuantizedLine &out)
+{
+    out.format = format;
+    out.vertices.clear();
+    out.indices.clear();
+    out.chunks.clear();
+    chunkSegments = std::min(std::max<std::size_t>(chunkSegments, 1), MAX_QUANTIZED_CHUNK_SEGMENTS);
+    // The points of the segments and the padding before and after, two vertices each
+    out.chunkVertices = 2 * (chunkSegments + 1) + 2 * LineUtils::ALIASED_LINE_PADDING;
+    const std::size_t segments = count > 1 ? count - 1 : 0;
+    if (segments == 0)
+        return;
+
+    std::vector<float> distances(count, 0.0f);
+    for (std::size_t i = 1; i < count; i++)
+        distances[i] = distances[i - 1] + glm::length(points[i] - points[i - 1]);
+
+    // The chunks share the indices of the longest one
+    const std::size_t longest = std::min(chunkSegments, segments);
+    out.indices.resize(longest * 6);
+    MathsUtils::writeIndices(longest, 0, out.indices.data());
+
+    for (std::size_t first = 0; first < segments; first += chunkSegments)
+    {
+        QuantizedChunk chunk;
+        chunk.firstSegment = first;
+        chunk.segmentCount = std::min(chunkSegments, segments - first);
+        chunk.firstVertex = out.vertices.size();
+        const std::size_t last = first + chunk.segmentCount;
+
+        // The points around the chunk are its padding: clamped at the ends of the polyline
+        const std::size_t before = first > 0 ? first - 1 : first;
+        const std::size_t after = last + 1 < count ? last + 1 : last;
+        glm::vec3 boundsMin = points[before];
+        glm::vec3 boundsMax = points[before];
+        for (std::size_t i = before + 1; i <= after; i++)
+        {
+            boundsMin = glm::min(boundsMin, points[i]);
+            boundsMax = glm::max(boundsMax, points[i]);
+        }
+        const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        glm::vec3 halfExtent = (boundsMax - boundsMin) * 0.5f;
+        // A flat axis quantizes to 0, any scale maps it back to the center
+        halfExtent = glm::max(halfExtent, glm::vec3(1e-30f));
+        chunk.dequantize = glm::scale(glm::translate(glm::mat4(1.0f), center), halfExtent);
+        chunk.distanceStart = distances[first];
+        chunk.distanceLength = distances[last] - distances[first];
+
+        chunk.positionError = 0.0f;
+        chunk.distanceError = 0.0f;
+        auto emit = [&](std::size_t i, bool measured)
+        {
+            const glm::vec3 q = (points[i] - center) / halfExtent;
+            const float t = chunk.distanceLength > 0.0f ? (distances[i] - chunk.distanceStart) / chunk.distanceLength : 0.0f;
+            const float w = 0.5f + 0.5f * glm::clamp(t, 0.0f, 1.0f);
+            for (float direction : {-1.0f, 1.0f})
+                out.vertices.push_back({pack(format, glm::vec4(q, direction * w))});
+
+            // What the shader reads back, see CompactLineVertex
+            const glm::vec4 back = unpack(format, out.vertices.back().packed);
+            const glm::vec3 position = center + glm::vec3(back) * halfExtent;
+            chunk.positionError = std::max(chunk.positionError, glm::length(position - points[i]));
+            if (measured)
+            {
+                const float distance = chunk.distanceStart + (std::abs(back.w) * 2.0f - 1.0f) * chunk.distanceLength;
+                chunk.distanceError = std::max(chunk.distanceError, std::abs(distance - distances[i]));
+            }
+        };
+        // The padding is only read as a neighbour, through `previous` and `next`
+        emit(before, false);
+        for (std::size_t i = first; i <= last; i++)
+            emit(i, true);
+        emit(after, false);
+        out.chunks.push_back(chunk);
+    }
+}
+
+void LineUtils::packChunks(const LineUtils::QuantizedLine &line, std::vector<glm::vec4> &texels)
+{
+    texels.clear();
+    texels.reserve(line.chunks.size() * QUANTIZED_CHUNK_TEXELS);
+    for (const QuantizedChunk &chunk : line.chunks)
+    {
+        for (int column = 0; column < 4; column++)
+            texels.push_back(chunk.dequantize[column]);
+        texels.push_back(glm::vec4(chunk.distanceStart, chunk.distanceLength, 0.0f, 0.0f));
+    }
+}
+
+void LineUtils::drawChunks(const LineUtils::QuantizedLine &line, LineUtils::PoolDrawList &list)
+{
+    list.clear();
+    for (const QuantizedChunk &chunk : line.chunks)
+    {
+        list.counts.push_back((GLsizei)(chunk.segmentCount * 6));
+        list.offsets.push_back(nullptr);
+        list.baseVertices.push_back((GLint)chunk.firstVertex);
+    }
+}
@@ -0,0 +1,197 @@
+#include "Base/line_style.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /*
+     * Rotates v around the unit vector axis (Rodrigues).
+     */
+    glm::vec3 rotate(const glm::vec3 &v, const glm::vec3 &axis, float angle)
+    {
+        const float c = std::cos(angle);
+        const float s = std::sin(angle);
+        return v * c + glm::cross(axis, v) * s + axis * glm::dot(axis, v) * (1.0f - c);
+    }
+
+    /*
+     * Unit vector perpendicular to the unit vector u, as close to up as possible.
+     */
+    glm::vec3 perpendicularAxis(const glm::vec3 &u, const glm::vec3 &up)
+    {
+        glm::vec3 axis = up - u * glm::dot(up, u);
+        if (glm::dot(axis, axis) < 1e-12f)
+            axis = glm::cross(u, std::fabs(u.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+        return glm::normalize(axis);
+    }
+
+    /*
+     * Appends vertices and triangles to a StyledLine.
+     * A pair is two vertices, direction -1 then 1. A vertex whose previous point is its position
+     * is offset along `next - position` by the shader, whatever the join.
+     */
+    struct Builder
+    {
+        LineUtils::StyledLine &out;
+
+        // The arc length of the point being built
+        float distance;
+
+        uint32_t vertex(const glm::vec3 &position, float direction, const glm::vec3 &next, const glm::vec3 &previous)
+        {
+            out.vertices.push_back({position, direction, next, previous, distance});
+            return (uint32_t)(out.vertices.size() - 1);
+        }
+
+        uint32_t pair(const glm::vec3 &position, const glm::vec3 &next, const glm::vec3 &previous)
+        {
+            const uint32_t first = vertex(position, -1.0f, next, previous);
+            vertex(position, 1.0f, next, previous);
+            return first;
+        }
+
+        void triangle(uint32_t a, uint32_t b, uint32_t c)
+        {
+            out.indices.push_back(a);
+            out.indices.push_back(b);
+            out.indices.push_back(c);
+        }
+
+        /*
+         * Two triangles between the pairs at both ends of a segment.
+         */
+        void quad(uint32_t start, uint32_t end)
+        {
+            triangle(start, start + 1, end);
+            triangle(end, start + 1, end + 1);
+        }
+
+        /*
+         * Triangles around p on both sides of the line, from the direction `from` rotated by
+         * `angle` around `axis`. The side outside the turn depends on the projection, so both
+         * are covered: the inner one is hidden under the segments.
+         */
+        void fan(const glm::vec3 &p, const glm::vec3 &from, const glm::vec3 &axis, float angle, unsigned int segments, float reach)
+        {
+            const uint32_t centre = vertex(p, 0.0f, p + from * reach, p);
+            uint32_t previous = pair(p, p + from * reach, p);
+            for (unsigned int k = 1; k <= segments; k++)
+            {
+                const glm::vec3 direction = rotate(from, axis, angle * k / segments);
+                const uint32_t current = pair(p, p + direction * reach, p);
+                triangle(centre, previous, current);
+                triangle(centre, previous + 1, current + 1);
+                previous = current;
+            }
+        }
+
+        /*
+         * A square of the line width centred on p, the half past p covering the cap. The
+         * corners are the directions rotated by +-45 degrees, pushed by sqrt(2) half widths.
+         */
+        void square(const glm::vec3 &p, const glm::vec3 &u, const glm::vec3 &axis, float reach)
+        {
+            const float quarter = (float)M_PI / 4.0f;
+            const glm::vec3 left = p + rotate(u, axis, quarter) * reach;
+            const glm::vec3 right = p + rotate(u, axis, -quarter) * reach;
+            const uint32_t c1 = vertex(p, (float)M_SQRT2, left, p);
+            const uint32_t c2 = vertex(p, -(float)M_SQRT2, left, p);
+            const uint32_t c3 = vertex(p, (float)M_SQRT2, right, p);
+            const uint32_t c4 = vertex(p, -(float)M_SQRT2, right, p);
+            triangle(c1, c3, c2);
+            triangle(c1, c2, c4);
+        }
+
+        void cap(const LineUtils::LineStyle &style, const glm::vec3 &p, const glm::vec3 &u, float reach)
+        {
+            const glm::vec3 axis = perpendicularAxis(u, style.up);
+            if (style.cap == LineUtils::SQUARE_CAP)
+                square(p, u, axis, reach);
+            else if (style.cap == LineUtils::ROUND_CAP)
+                fan(p, u, axis, (float)M_PI, std::max(style.roundSegments, 1u), reach);
+        }
+    };
+}
+
+void LineUtils::tessellate(const glm::vec3 *points, std::size_t count, const LineUtils::LineStyle &style, LineUtils::StyledLine &out)
+{
+    out.vertices.clear();
+    out.indices.clear();
+    out.segmentIndices.assign(count > 1 ? count : 1, 0);
+
+    // The distinct points, and their index in the input
+    std::vector<glm::vec3> kept;
+    std::vector<std::size_t> origin;
+    for (std::size_t i = 0; i < count; i++)
+        if (kept.empty() || points[i] != kept.back())
+        {
+            kept.push_back(points[i]);
+            origin.push_back(i);
+        }
+    if (kept.size() < 2)
+        return;
+
+    Builder builder{out, 0.0f};
+    const std::size_t n = kept.size();
+    const unsigned int roundSegments = std::max(style.roundSegments, 1u);
+    const float roundStep = (float)M_PI / roundSegments;
+    std::size_t filled = 0;
+    uint32_t start = 0;
+    bool shared = false;
+    float distance = 0.0f;
+
+    for (std::size_t j = 0; j + 1 < n; j++)
+    {
+        const glm::vec3 &a = kept[j];
+        const glm::vec3 &b = kept[j + 1];
+        const glm::vec3 u = glm::normalize(b - a);
+        const float length = glm::length(b - a);
+
+        // Skipped repeated points own empty segments, the geometry goes to the last one
+        for (; filled < origin[j + 1]; filled++)
+            out.segmentIndices[filled] = (uint32_t)out.indices.size();
+
+        builder.distance = distance;
+        if (j == 0)
+            builder.cap(style, a, -u, length);
+        if (!shared)
+            start = builder.pair(a, b, a);
+
+        // Join with the next segment: a miter shares the end pair, anything else ends with a butt
+        bool miter = true;
+        glm::vec3 v = u;
+        glm::vec3 axis = u;
+        float turn = 0.0f;
+        if (j + 2 < n)
+        {
+            v = glm::normalize(kept[j + 2] - b);
+            const float cosine = glm::clamp(glm::dot(u, v), -1.0f, 1.0f);
+            turn = std::acos(cosine);
+            // 1 / cos(turn / 2) <= limit
+            const float limit = style.join == MITER_JOIN ? style.miterLimit : 1.0f / std::cos(roundStep * 0.5f);
+            miter = (1.0f + cosine) * 0.5f * limit * limit >= 1.0f;
+            const glm::vec3 normal = glm::cross(u, v);
+            axis = glm::dot(normal, normal) > 1e-12f ? glm::normalize(normal) : perpendicularAxis(u, style.up);
+        }
+        builder.distance = distance + length;
+        const uint32_t end = (j + 2 < n && miter) ? builder.pair(b, kept[j + 2], a) : builder.pair(b, b, a);
+        builder.quad(start, end);
+
+        if (j + 2 < n && !miter)
+        {
+            const float reach = std::min(length, glm::length(kept[j + 2] - b));
+            if (style.join == ROUND_JOIN)
+                builder.fan(b, u, axis, turn, std::max(1u, (unsigned int)std::ceil(turn / roundStep)), reach);
+            else
+                builder.fan(b, u, axis, turn, 1, reach);
+        }
+        if (j + 2 == n)
+            builder.cap(style, b, u, length);
+
+        distance += length;
+        shared = miter;
+        start = end;
+    }
+    for (; filled < out.segmentIndices.size(); filled++)
+        out.segmentIndices[filled] = (uint32_t)out.indices.size();
+}
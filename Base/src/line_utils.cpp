@@ -0,0 +1,86 @@
+#include "Base/line_utils.h"
+#include <algorithm>
+
+std::size_t LineUtils::expandedSize(std::size_t count)
+{
+    return count * 2;
+}
+
+void LineUtils::expand(const glm::vec3 *points, std::size_t count, LineUtils::LineVertex *out)
+{
+    LineUtils::expandRange(points, count, 0, count, 0.0f, out);
+}
+
+void LineUtils::expandRange(const glm::vec3 *points, std::size_t count, std::size_t first, std::size_t last, float startDistance, LineUtils::LineVertex *out)
+{
+    float distance = startDistance;
+    for (std::size_t i = first; i < last; i++)
+    {
+        const std::size_t v = 2 * (i - first);
+        const glm::vec3 &position = points[i];
+        const glm::vec3 &previous = points[i > 0 ? i - 1 : 0];
+        const glm::vec3 &next = points[i + 1 < count ? i + 1 : count - 1];
+        if (i > first)
+            distance += glm::length(position - previous);
+
+        out[v + 0] = {position, -1.0f, next, previous, distance};
+        out[v + 1] = {position, 1.0f, next, previous, distance};
+    }
+}
+
+float LineUtils::arcLength(const glm::vec3 *points, std::size_t first, std::size_t last)
+{
+    float length = 0.0f;
+    for (std::size_t i = first; i < last; i++)
+        length += glm::length(points[i + 1] - points[i]);
+    return length;
+}
+
+std::size_t LineUtils::instancedSize(std::size_t count)
+{
+    return count > 0 ? count + 2 : 0;
+}
+
+void LineUtils::expandInstanced(const glm::vec3 *points, std::size_t count, glm::vec4 *out)
+{
+    if (count == 0)
+        return;
+    float distance = 0.0f;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (i > 0)
+            distance += glm::length(points[i] - points[i - 1]);
+        out[i + 1] = glm::vec4(points[i], distance);
+    }
+    out[0] = out[1];
+    out[count + 1] = out[count];
+}
+
+std::size_t LineUtils::aliasedSize(std::size_t count)
+{
+    return count > 0 ? 2 * count + 2 * LineUtils::ALIASED_LINE_PADDING : 0;
+}
+
+void LineUtils::expandAliased(const glm::vec3 *points, std::size_t count, LineUtils::AliasedLineVertex *out)
+{
+    LineUtils::expandAliasedRange(points, count, 0, count, 0.0f, out);
+}
+
+void LineUtils::expandAliasedRange(const glm::vec3 *points, std::size_t count, std::size_t first, std::size_t last, float startDistance, LineUtils::AliasedLineVertex *out)
+{
+    float distance = startDistance;
+    for (std::size_t i = first; i < last; i++)
+    {
+        if (i > first)
+            distance += glm::length(points[i] - points[i - 1]);
+        const std::size_t v = LineUtils::ALIASED_LINE_PADDING + 2 * i;
+        out[v + 0] = {points[i], -1.0f, distance};
+        out[v + 1] = {points[i], 1.0f, distance};
+    }
+    // Only read as a neighbour, through `previous` and `next`
+    if (first == 0 && last > 0)
+        std::copy(out + LineUtils::ALIASED_LINE_PADDING, out + 2 * LineUtils::ALIASED_LINE_PADDING, out);
+    const std::size_t end = LineUtils::ALIASED_LINE_PADDING + 2 * count;
+    if (last == count && last > first)
+        std::copy(out + end - 2, out + end, out + end);
+}
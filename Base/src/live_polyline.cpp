@@ -0,0 +1,149 @@
+#include "Base/live_polyline.h"
+#include "Base/gl_dispatch.h"
+#include "Base/maths_utils.h"
+#include <algorithm>
+
+namespace
+{
+    /*
+     * Sends size bytes at offset of the buffer bound to target, through the ring if any.
+     */
+    void send(GLenum target, std::size_t offset, std::size_t size, const void *data, GLUtils::UploadRing *staging)
+    {
+        GLintptr source = 0;
+        if (staging && staging->write(data, size, 4, source))
+        {
+            GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, staging->getBuffer());
+            GLUtils::gl().CopyBufferSubData(GL_COPY_READ_BUFFER, target, source, offset, size);
+            GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        else
+            GLUtils::gl().BufferSubData(target, offset, size, data);
+    }
+}
+
+LineUtils::LivePolyline::LivePolyline() {}
+
+LineUtils::LivePolyline::~LivePolyline()
+{
+    if (vertexBuffer)
+        GLUtils::gl().DeleteBuffers(1, &vertexBuffer);
+    if (indexBuffer)
+        GLUtils::gl().DeleteBuffers(1, &indexBuffer);
+}
+
+void LineUtils::LivePolyline::retessellate(std::size_t first, std::size_t last)
+{
+    // The arc length of the first point only depends on the points before it
+    float startDistance = 0.0f;
+    if (first > 0)
+        startDistance = vertices[LineUtils::ALIASED_LINE_PADDING + 2 * (first - 1)].distance + glm::length(points[first] - points[first - 1]);
+    LineUtils::expandAliasedRange(points.data(), points.size(), first, last, startDistance, vertices.data());
+
+    // With the padding of the ends
+    const std::size_t begin = first > 0 ? LineUtils::ALIASED_LINE_PADDING + 2 * first : 0;
+    const std::size_t end = last < points.size() ? LineUtils::ALIASED_LINE_PADDING + 2 * last : vertices.size();
+    if (dirtyVertexBegin == dirtyVertexEnd)
+        dirtyVertexBegin = begin;
+    dirtyVertexBegin = std::min(dirtyVertexBegin, begin);
+    dirtyVertexEnd = std::max(dirtyVertexEnd, end);
+}
+
+void LineUtils::LivePolyline::append(const glm::vec3 *newPoints, std::size_t count)
+{
+    if (count == 0)
+        return;
+    const std::size_t previousCount = points.size();
+    points.insert(points.end(), newPoints, newPoints + count);
+    vertices.resize(LineUtils::aliasedSize(points.size()));
+
+    // The joins are computed by the shader from the neighbours: the previous points stay as is
+    retessellate(previousCount, points.size());
+
+    // Two triangles per new segment, the first one ending at the new points
+    const std::size_t first = previousCount > 0 ? previousCount - 1 : 0;
+    const std::size_t segments = points.size() - 1;
+    const std::size_t firstIndex = indices.size();
+    indices.resize(segments * 6);
+    MathsUtils::writeIndices(segments - first, 2 * first, indices.data() + first * 6);
+    if (dirtyIndexBegin == dirtyIndexEnd)
+        dirtyIndexBegin = firstIndex;
+    dirtyIndexBegin = std::min(dirtyIndexBegin, firstIndex);
+    dirtyIndexEnd = indices.size();
+}
+
+void LineUtils::LivePolyline::edit(std::size_t index, const glm::vec3 &point)
+{
+    if (index >= points.size())
+        return;
+    points[index] = point;
+    // The neighbours read it through the aliased attributes, but the arc length of all the
+    // following points changes
+    retessellate(index, points.size());
+}
+
+std::size_t LineUtils::LivePolyline::upload(GLUtils::UploadRing *staging)
+{
+    std::size_t uploaded = 0;
+    if (!vertexBuffer)
+        GLUtils::gl().GenBuffers(1, &vertexBuffer);
+    if (!indexBuffer)
+        GLUtils::gl().GenBuffers(1, &indexBuffer);
+
+    if (dirtyVertexBegin != dirtyVertexEnd)
+    {
+        GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        if (vertices.size() > vertexCapacity)
+        {
+            vertexCapacity = std::max(vertices.size(), vertexCapacity * 2);
+            GLUtils::gl().BufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(AliasedLineVertex), NULL, GL_DYNAMIC_DRAW);
+            dirtyVertexBegin = 0;
+            dirtyVertexEnd = vertices.size();
+        }
+        const std::size_t size = (dirtyVertexEnd - dirtyVertexBegin) * sizeof(AliasedLineVertex);
+        send(GL_ARRAY_BUFFER, dirtyVertexBegin * sizeof(AliasedLineVertex), size, &vertices[dirtyVertexBegin], staging);
+        GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, 0);
+        uploaded += size;
+        dirtyVertexBegin = dirtyVertexEnd = 0;
+    }
+
+    if (dirtyIndexBegin != dirtyIndexEnd)
+    {
+        // The element array binding is part of the VAO state, so we don't unbind it
+        // from a VAO which may be bound: copy through GL_COPY_WRITE_BUFFER instead
+        GLUtils::gl().BindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+        if (indices.size() > indexCapacity)
+        {
+            indexCapacity = std::max(indices.size(), indexCapacity * 2);
+            GLUtils::gl().BufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(uint32_t), NULL, GL_DYNAMIC_DRAW);
+            dirtyIndexBegin = 0;
+            dirtyIndexEnd = indices.size();
+        }
+        const std::size_t size = (dirtyIndexEnd - dirtyIndexBegin) * sizeof(uint32_t);
+        send(GL_COPY_WRITE_BUFFER, dirtyIndexBegin * sizeof(uint32_t), size, &indices[dirtyIndexBegin], staging);
+        GLUtils::gl().BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        uploaded += size;
+        dirtyIndexBegin = dirtyIndexEnd = 0;
+    }
+    return uploaded;
+}
+
+GLuint LineUtils::LivePolyline::getVertexBuffer() const
+{
+    return vertexBuffer;
+}
+
+GLuint LineUtils::LivePolyline::getIndexBuffer() const
+{
+    return indexBuffer;
+}
+
+GLsizei LineUtils::LivePolyline::getIndexCount() const
+{
+    return (GLsizei)indices.size();
+}
+
+const std::vector<glm::vec3> &LineUtils::LivePolyline::getPoints() const
+{
+    return points;
+}
@@ -1,4 +1,6 @@
 #include "Base/maths_utils.h"
+#include "Base/logs.h"
+#include <iostream>
 
 const float MathsUtils::x(const vertex *v)
 {
@@ -62,23 +64,32 @@ std::vector<float> MathsUtils::duplicate(std::vector<std::vector<float>> array,
     return result;
 }
 
-std::vector<uint16_t> MathsUtils::createIndices(int length)
-{
-    std::vector<uint16_t> indices(length * 6);
-    int c = 0, index = 0;
-    for (int j = 0; j < length; j++) {
-      int i = index;
-      indices[c++] = i + 0; 
-      indices[c++] = i + 1;
-      indices[c++] = i + 2;
-      indices[c++] = i + 2;
-      indices[c++] = i + 1;
-      indices[c++] = i + 3;
-      index += 2;
+std::vector<uint16_t> MathsUtils::createIndices(std::size_t length)
+{
+    if (MathsUtils::indexType(length * 2) != GL_UNSIGNED_SHORT)
+    {
+        error("createIndices: " << length << " points need 32-bit indices, see createIndices32");
+        return std::vector<uint16_t>();
     }
+    std::size_t segments = length > 1 ? length - 1 : 0;
+    std::vector<uint16_t> indices(segments * 6);
+    MathsUtils::writeIndices(segments, 0, indices.data());
+    return indices;
+}
+
+std::vector<uint32_t> MathsUtils::createIndices32(std::size_t length)
+{
+    std::size_t segments = length > 1 ? length - 1 : 0;
+    std::vector<uint32_t> indices(segments * 6);
+    MathsUtils::writeIndices(segments, 0, indices.data());
     return indices;
 }
 
+GLenum MathsUtils::indexType(std::size_t vertexCount)
+{
+    return vertexCount <= MAX_UNSIGNED_SHORT_VERTICES ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
 std::vector<std::vector<float>> MathsUtils::relative(std::vector<std::vector<float>> array, int offset)
 {
     std::vector<std::vector<float>> result(array.size(), std::vector<float>(3, 0));
@@ -99,4 +110,36 @@ int MathsUtils::clamp(int value, int begin, int end)
     else if (value < begin)
         return begin;
     return value;
+}
+
+MathsUtils::Frustum MathsUtils::frustumFromMatrix(const glm::mat4 &projViewModel, float margin)
+{
+    // Gribb & Hartmann: -w <= x, y, z <= w, with the rows of the matrix
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+        rows[i] = glm::vec4(projViewModel[0][i], projViewModel[1][i], projViewModel[2][i], projViewModel[3][i]);
+
+    Frustum frustum;
+    const glm::vec4 push(0.0f, 0.0f, 0.0f, margin);
+    frustum.planes[0] = rows[3] + rows[0] + push;
+    frustum.planes[1] = rows[3] - rows[0] + push;
+    frustum.planes[2] = rows[3] + rows[1] + push;
+    frustum.planes[3] = rows[3] - rows[1] + push;
+    frustum.planes[4] = rows[3] + rows[2];
+    frustum.planes[5] = rows[3] - rows[2];
+    return frustum;
+}
+
+bool MathsUtils::intersects(const MathsUtils::Frustum &frustum, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    for (const glm::vec4 &plane : frustum.planes)
+    {
+        // The corner of the box the furthest along the plane normal
+        glm::vec3 corner(plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                         plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                         plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+            return false;
+    }
+    return true;
 }
\ No newline at end of file
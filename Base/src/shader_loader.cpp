@@ -0,0 +1,192 @@
+#include "Base/shader_loader.h"
+#include "Base/logs.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+ShaderUtils::MappedFile::MappedFile()
+{
+}
+
+ShaderUtils::MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool ShaderUtils::MappedFile::open(const std::string &path)
+{
+    close();
+#if defined(__unix__) || defined(__APPLE__)
+    const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        return false;
+    struct stat status = {};
+    if (fstat(descriptor, &status) != 0)
+    {
+        ::close(descriptor);
+        return false;
+    }
+    // An empty file cannot be mapped, and needs not be
+    if (status.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, (std::size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ::close(descriptor);
+            return false;
+        }
+        data = (const char *)mapping;
+        size = (std::size_t)status.st_size;
+    }
+    // The mapping keeps the file
+    ::close(descriptor);
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    const std::size_t length = (std::size_t)file.tellg();
+    char *buffer = new char[length + 1];
+    file.seekg(0);
+    if (!file.read(buffer, length))
+    {
+        delete[] buffer;
+        return false;
+    }
+    buffer[length] = '\0';
+    data = buffer;
+    size = length;
+    return true;
+#endif
+}
+
+void ShaderUtils::MappedFile::close()
+{
+    if (!data)
+        return;
+#if defined(__unix__) || defined(__APPLE__)
+    munmap((void *)data, size);
+#else
+    delete[] data;
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+std::string_view ShaderUtils::MappedFile::contents() const
+{
+    return std::string_view(data, size);
+}
+
+ShaderUtils::ShaderLoader::ShaderLoader(const ShaderUtils::EmbeddedFile *files, std::size_t count, const std::string &override_directory)
+    : files(files), count(count)
+{
+    if (!override_directory.empty())
+        overrideDirectories.push_back(override_directory);
+}
+
+void ShaderUtils::ShaderLoader::addOverrideDirectory(const std::string &directory)
+{
+    overrideDirectories.push_back(directory);
+}
+
+const ShaderUtils::EmbeddedFile *ShaderUtils::ShaderLoader::find(std::string_view name) const
+{
+    // A handful of files: a linear search, without hashing nor allocating
+    for (std::size_t i = 0; i < count; i++)
+        if (files[i].name == name)
+            return &files[i];
+    return nullptr;
+}
+
+bool ShaderUtils::ShaderLoader::isOverridden(std::string_view name) const
+{
+    return !overrideDirectories.empty() &&
+           (overridesAll || std::find(overridden.begin(), overridden.end(), name) != overridden.end());
+}
+
+bool ShaderUtils::ShaderLoader::load(std::string_view name, std::string_view &source)
+{
+    if (isOverridden(name))
+    {
+        // Mapped once, until overridden again: the views of the mapping stay valid meanwhile
+        auto file = mapped.find(std::string(name));
+        if (file == mapped.end())
+        {
+            auto mapping = std::make_unique<MappedFile>();
+            if (mapping->open(getOverridePath(name)))
+                file = mapped.emplace(std::string(name), std::move(mapping)).first;
+        }
+        if (file != mapped.end())
+        {
+            source = file->second->contents();
+            return true;
+        }
+    }
+    const ShaderUtils::EmbeddedFile *embedded = find(name);
+    if (!embedded)
+    {
+        error("no shader " << name << ", embedded or at " << getOverridePath(name));
+        return false;
+    }
+    source = embedded->contents;
+    return true;
+}
+
+bool ShaderUtils::ShaderLoader::contains(std::string_view name) const
+{
+    if (find(name))
+        return true;
+    std::error_code errorCode;
+    return isOverridden(name) && std::filesystem::is_regular_file(getOverridePath(name), errorCode);
+}
+
+void ShaderUtils::ShaderLoader::override(std::string_view name)
+{
+    if (std::find(overridden.begin(), overridden.end(), name) == overridden.end())
+        overridden.emplace_back(name);
+    // Mapped again on the next load, the file may have changed
+    mapped.erase(std::string(name));
+}
+
+void ShaderUtils::ShaderLoader::overrideAll()
+{
+    overridesAll = true;
+    mapped.clear();
+}
+
+std::string ShaderUtils::ShaderLoader::getOverridePath(std::string_view name) const
+{
+    std::error_code errorCode;
+    for (const std::string &directory : overrideDirectories)
+    {
+        const std::filesystem::path path = (std::filesystem::path(directory) / std::filesystem::path(name)).lexically_normal();
+        if (std::filesystem::is_regular_file(path, errorCode))
+            return path.string();
+    }
+    const std::string first = overrideDirectories.empty() ? "" : overrideDirectories.front();
+    return (std::filesystem::path(first) / std::filesystem::path(name)).lexically_normal().string();
+}
+
+std::string ShaderUtils::ShaderLoader::getName(const std::string &path) const
+{
+    std::error_code errorCode;
+    const std::filesystem::path file = std::filesystem::absolute(path, errorCode).lexically_normal();
+    for (const std::string &overrideDirectory : overrideDirectories)
+    {
+        const std::filesystem::path directory = std::filesystem::absolute(overrideDirectory, errorCode).lexically_normal();
+        const std::filesystem::path relative = file.lexically_relative(directory);
+        if (!relative.empty() && *relative.begin() != "..")
+            return relative.generic_string();
+    }
+    return "";
+}
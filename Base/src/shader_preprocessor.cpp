@@ -0,0 +1,283 @@
+#include "Base/shader_preprocessor.h"
+#include "Base/logs.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+
+namespace
+{
+    bool startsWith(std::string_view text, std::string_view prefix)
+    {
+        return text.substr(0, prefix.size()) == prefix;
+    }
+
+    /*
+     * The index of a file in the files read, the source string number of its #line.
+     */
+    std::size_t fileIndex(std::vector<std::string> &files, const std::string &path)
+    {
+        auto file = std::find(files.begin(), files.end(), path);
+        if (file != files.end())
+            return file - files.begin();
+        files.push_back(path);
+        return files.size() - 1;
+    }
+
+    /*
+     * The defines sorted by name, so that the same set gives the same source, and its key.
+     */
+    ShaderUtils::Defines sorted(const ShaderUtils::Defines &defines)
+    {
+        ShaderUtils::Defines copy = defines;
+        std::sort(copy.begin(), copy.end());
+        return copy;
+    }
+
+    std::string definesKey(const ShaderUtils::Defines &defines)
+    {
+        std::string key;
+        for (const auto &define : defines)
+            key += define.first + "=" + define.second + ";";
+        return key;
+    }
+}
+
+void ShaderUtils::Preprocessor::addIncludeDirectory(const std::string &directory)
+{
+    includeDirectories.push_back(directory);
+}
+
+void ShaderUtils::Preprocessor::setLoader(ShaderUtils::ShaderLoader &shaders)
+{
+    loader = &shaders;
+}
+
+bool ShaderUtils::Preprocessor::process(const std::string &path, const ShaderUtils::Defines &defines, std::string &output, std::vector<std::string> &files) const
+{
+    output.clear();
+    files.clear();
+    std::vector<std::string> included;
+    if (!expand(std::filesystem::path(path).lexically_normal().string(), 0, output, files, included))
+        return false;
+
+    // The defines go right after #version, which must come first
+    std::string block;
+    for (const auto &define : defines)
+        block += "#define " + define.first + (define.second.empty() ? "" : " " + define.second) + "\n";
+    std::size_t start = 0;
+    std::size_t line = 1;
+    for (std::size_t end = output.find('\n'); end != std::string::npos; end = output.find('\n', start))
+    {
+        std::string_view text = std::string_view(output).substr(start, end - start);
+        const std::size_t first = text.find_first_not_of(" \t");
+        start = end + 1;
+        line++;
+        if (first != std::string_view::npos && startsWith(text.substr(first), "#version"))
+        {
+            output.insert(start, block + "#line " + std::to_string(line) + " 0\n");
+            return true;
+        }
+    }
+    output.insert(0, block + "#line 1 0\n");
+    return true;
+}
+
+bool ShaderUtils::Preprocessor::expand(const std::string &path, std::size_t depth, std::string &output, std::vector<std::string> &files, std::vector<std::string> &included) const
+{
+    const std::size_t index = fileIndex(files, path);
+    if (depth > ShaderUtils::MAX_INCLUDE_DEPTH)
+    {
+        error("shader includes nested deeper than " << ShaderUtils::MAX_INCLUDE_DEPTH << " at " << path << ", is it included recursively?");
+        return false;
+    }
+    // Embedded or mapped by the loader, read from the disk otherwise
+    std::string buffer;
+    std::string_view contents;
+    if (loader)
+    {
+        if (!loader->load(path, contents))
+            return false;
+    }
+    else
+    {
+        std::ifstream stream(path);
+        if (!stream)
+        {
+            error("cannot read the shader " << path);
+            return false;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        contents = buffer;
+    }
+
+    std::size_t number = 0;
+    for (std::size_t start = 0; start < contents.size();)
+    {
+        const std::size_t end = std::min(contents.find('\n', start), contents.size());
+        const std::string_view line = contents.substr(start, end - start);
+        start = end + 1;
+        number++;
+        const std::size_t first = line.find_first_not_of(" \t");
+        const std::string_view text = first == std::string_view::npos ? std::string_view() : line.substr(first);
+        if (startsWith(text, "#pragma once"))
+        {
+            included.push_back(path);
+            output += "\n";
+            continue;
+        }
+        if (!startsWith(text, "#include"))
+        {
+            output += line;
+            output += "\n";
+            continue;
+        }
+
+        const std::size_t open = text.find_first_of("\"<");
+        const std::size_t close = open == std::string_view::npos ? open : text.find_first_of("\">", open + 1);
+        if (close == std::string_view::npos)
+        {
+            error(path << ":" << number << ": malformed #include");
+            return false;
+        }
+        const std::string name(text.substr(open + 1, close - open - 1));
+        // Next to the including file first
+        auto exists = [this](const std::filesystem::path &include) {
+            return loader ? loader->contains(include.lexically_normal().string()) : std::filesystem::exists(include);
+        };
+        std::filesystem::path include = std::filesystem::path(path).parent_path() / name;
+        for (std::size_t i = 0; i < includeDirectories.size() && !exists(include); i++)
+            include = std::filesystem::path(includeDirectories[i]) / name;
+        if (!exists(include))
+        {
+            error(path << ":" << number << ": cannot find the include " << name);
+            // Watched all the same, it may be created
+            fileIndex(files, (std::filesystem::path(path).parent_path() / name).lexically_normal().string());
+            return false;
+        }
+        const std::string includePath = include.lexically_normal().string();
+        if (std::find(included.begin(), included.end(), includePath) != included.end())
+        {
+            output += "\n";
+            continue;
+        }
+        output += "#line 1 " + std::to_string(fileIndex(files, includePath)) + "\n";
+        if (!expand(includePath, depth + 1, output, files, included))
+            return false;
+        output += "#line " + std::to_string(number + 1) + " " + std::to_string(index) + "\n";
+    }
+    return true;
+}
+
+ShaderUtils::Preprocessor &ShaderUtils::PermutationCache::getPreprocessor()
+{
+    return preprocessor;
+}
+
+void ShaderUtils::PermutationCache::setBinaryCache(const std::string &directory)
+{
+    binaryDirectory = directory;
+}
+
+ShaderUtils::Program &ShaderUtils::PermutationCache::get(const std::string &vertex_path, const std::string &fragment_path, const ShaderUtils::Defines &vertex_defines, const ShaderUtils::Defines &fragment_defines)
+{
+    const ShaderUtils::Defines vertexDefines = sorted(vertex_defines);
+    const ShaderUtils::Defines fragmentDefines = sorted(fragment_defines);
+    const std::string key = vertex_path + "\n" + fragment_path + "\n" + definesKey(vertexDefines) + "\n" + definesKey(fragmentDefines);
+    auto inserted = permutations.try_emplace(key);
+    Permutation &permutation = inserted.first->second;
+    if (inserted.second)
+    {
+        permutation.vertexPath = vertex_path;
+        permutation.fragmentPath = fragment_path;
+        permutation.vertexDefines = vertexDefines;
+        permutation.fragmentDefines = fragmentDefines;
+        if (!binaryDirectory.empty())
+            permutation.program.setBinaryCache(binaryDirectory);
+        permutation.program.setStageCache(stages);
+        submit(permutation);
+    }
+    return permutation.program;
+}
+
+void ShaderUtils::PermutationCache::submit(Permutation &permutation)
+{
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::vector<std::string> fragmentFiles;
+    bool processed = preprocessor.process(permutation.vertexPath, permutation.vertexDefines, vertexSource, permutation.files);
+    processed &= preprocessor.process(permutation.fragmentPath, permutation.fragmentDefines, fragmentSource, fragmentFiles);
+    for (const std::string &file : fragmentFiles)
+        fileIndex(permutation.files, file);
+    permutation.failed = !processed;
+    if (processed)
+        permutation.program.submitProgram(vertexSource, fragmentSource);
+}
+
+std::size_t ShaderUtils::PermutationCache::reload(const std::vector<std::string> &changed)
+{
+    std::size_t submitted = 0;
+    for (auto &entry : permutations)
+    {
+        Permutation &permutation = entry.second;
+        bool read = changed.empty();
+        for (const std::string &file : changed)
+            read |= std::find(permutation.files.begin(), permutation.files.end(), std::filesystem::path(file).lexically_normal().string()) != permutation.files.end();
+        if (!read)
+            continue;
+        submit(permutation);
+        submitted++;
+    }
+    return submitted;
+}
+
+ShaderUtils::ProgramStatus ShaderUtils::PermutationCache::poll(bool wait)
+{
+    bool ready = false;
+    bool pending = false;
+    bool failed = false;
+    for (auto &entry : permutations)
+    {
+        Permutation &permutation = entry.second;
+        if (permutation.failed)
+        {
+            permutation.failed = false;
+            failed = true;
+            continue;
+        }
+        const ShaderUtils::ProgramStatus status = wait ? permutation.program.finishProgram() : permutation.program.pollProgram();
+        ready |= status == ShaderUtils::PROGRAM_READY;
+        pending |= status == ShaderUtils::PROGRAM_PENDING;
+        failed |= status == ShaderUtils::PROGRAM_FAILED;
+    }
+    return ready ? ShaderUtils::PROGRAM_READY : failed ? ShaderUtils::PROGRAM_FAILED : pending ? ShaderUtils::PROGRAM_PENDING : ShaderUtils::PROGRAM_IDLE;
+}
+
+std::vector<ShaderUtils::Program *> ShaderUtils::PermutationCache::getPrograms()
+{
+    std::vector<ShaderUtils::Program *> programs;
+    for (auto &entry : permutations)
+        programs.push_back(&entry.second.program);
+    return programs;
+}
+
+std::vector<std::string> ShaderUtils::PermutationCache::getFiles() const
+{
+    std::vector<std::string> files;
+    for (const auto &entry : permutations)
+        for (const std::string &file : entry.second.files)
+            fileIndex(files, file);
+    return files;
+}
+
+const ShaderUtils::StageCache &ShaderUtils::PermutationCache::getStageCache() const
+{
+    return stages;
+}
+
+std::size_t ShaderUtils::PermutationCache::size() const
+{
+    return permutations.size();
+}
@@ -6,22 +6,177 @@
 
 #include "Base/logs.h"
 #include "Base/shader_utils.h"
+#include "Base/gl_dispatch.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <optional>
 #include <iostream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /*
+     * The header of a cached binary: the magic, then the binary format of the driver.
+     */
+    const uint32_t BINARY_MAGIC = 0x42504c47; // "GLPB"
+
+    /*
+     * Whether the driver compiles on its own threads, see enableParallelCompile.
+     */
+    bool parallelCompile = false;
+
+    typedef void (*MaxShaderCompilerThreadsProc)(GLuint count);
+
+    /*
+     * Logs the compilation error of a shader, if any.
+     */
+    void logCompileError(unsigned int shader, const char *stage)
+    {
+        int success = {};
+        GLUtils::gl().GetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (success)
+            return;
+        char errorMessage[1024] = {};
+        GLUtils::gl().GetShaderInfoLog(shader, 1024, NULL, errorMessage);
+        error(stage << " shader compilation error : " << errorMessage);
+    }
+
+    uint64_t hashBytes(uint64_t hash, const char *bytes, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; i++)
+            hash = (hash ^ (uint8_t)bytes[i]) * 1099511628211ull;
+        // Separates the strings, "ab" + "c" and "a" + "bc" differ
+        return (hash ^ 0xff) * 1099511628211ull;
+    }
+
+    /*
+     * Starts compiling a source by its length: views of embedded or mapped files end
+     * without a null terminator.
+     */
+    void compileSource(unsigned int shader, std::string_view source)
+    {
+        const char *data = source.data();
+        const GLint length = (GLint)source.size();
+        GLUtils::gl().ShaderSource(shader, 1, &data, &length);
+        GLUtils::gl().CompileShader(shader);
+    }
+
+    std::string binaryPath(const std::string &directory, uint64_t key)
+    {
+        char name[32] = {};
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return (std::filesystem::path(directory) / name).string();
+    }
+}
+
+bool ShaderUtils::enableParallelCompile(GLUtils::ProcAddress (*getProcAddress)(const char *), GLuint threads)
+{
+    // Both extensions share the enums, only the suffix of the entry point differs
+    const char *entryPoint = GLUtils::hasExtension("GL_KHR_parallel_shader_compile")   ? "glMaxShaderCompilerThreadsKHR"
+                             : GLUtils::hasExtension("GL_ARB_parallel_shader_compile") ? "glMaxShaderCompilerThreadsARB"
+                                                                                       : nullptr;
+    MaxShaderCompilerThreadsProc maxShaderCompilerThreads = entryPoint ? (MaxShaderCompilerThreadsProc)getProcAddress(entryPoint) : nullptr;
+    if (!maxShaderCompilerThreads)
+        return false;
+    maxShaderCompilerThreads(threads);
+    parallelCompile = true;
+    return true;
+}
+
+ShaderUtils::StageCache::StageCache() {}
+
+ShaderUtils::StageCache::~StageCache()
+{
+    for (const auto &stage : stages)
+        GLUtils::gl().DeleteShader(stage.second.shader);
+}
+
+unsigned int ShaderUtils::StageCache::acquire(const ShaderUtils::Type shader_type, std::string_view shader_source)
+{
+    const bool isFragmentShader = shader_type == ShaderUtils::Type::FRAGMENT_SHADER_TYPE;
+    const char type = isFragmentShader ? 'f' : 'v';
+    const uint64_t key = hashBytes(hashBytes(14695981039346656037ull, &type, 1), shader_source.data(), shader_source.size());
+    auto stage = stages.find(key);
+    if (stage != stages.end())
+    {
+        stage->second.references++;
+        return stage->second.shader;
+    }
+
+    // No status is queried here: that would wait for the driver
+    const unsigned int shader = GLUtils::gl().CreateShader(isFragmentShader ? GL_FRAGMENT_SHADER : GL_VERTEX_SHADER);
+    compileSource(shader, shader_source);
+    stages.emplace(key, Stage{shader, 1});
+    keys.emplace(shader, key);
+    compiled++;
+    return shader;
+}
+
+void ShaderUtils::StageCache::release(unsigned int shader)
+{
+    auto key = keys.find(shader);
+    if (key == keys.end())
+        return;
+    auto stage = stages.find(key->second);
+    if (--stage->second.references > 0)
+        return;
+    // Still attached to a program, the driver deletes it with the program
+    GLUtils::gl().DeleteShader(shader);
+    stages.erase(stage);
+    keys.erase(key);
+}
+
+std::size_t ShaderUtils::StageCache::getCompileCount() const
+{
+    return compiled;
+}
+
+std::size_t ShaderUtils::StageCache::size() const
+{
+    return stages.size();
+}
 
 ShaderUtils::Program::Program() {}
 
 ShaderUtils::Program::~Program()
 {
+    discardPending();
+    releaseShader(linkedVertexShader);
+    releaseShader(linkedFragmentShader);
     if (vertexShader.has_value())
-        glDeleteShader(vertexShader.value());
-    if (vertexShader.has_value())
-        glDeleteShader(fragmentShader.value());
+        GLUtils::gl().DeleteShader(vertexShader.value());
+    if (fragmentShader.has_value())
+        GLUtils::gl().DeleteShader(fragmentShader.value());
     if (registered && program.has_value())
-        glDeleteProgram(program.value());
+        GLUtils::gl().DeleteProgram(program.value());
+}
+
+void ShaderUtils::Program::setBinaryCache(const std::string &directory)
+{
+    cacheDirectory = directory;
+}
+
+void ShaderUtils::Program::setStageCache(ShaderUtils::StageCache &stages)
+{
+    stageCache = &stages;
 }
 
 bool ShaderUtils::Program::registerShader(const ShaderUtils::Type shader_type, const char *shader_source)
+{
+    if (cacheDirectory.empty())
+        return compileShader(shader_type, shader_source);
+    // Compiled by registerProgram, if the cache misses
+    if (shader_type == ShaderUtils::Type::FRAGMENT_SHADER_TYPE)
+        fragmentSource = shader_source;
+    else
+        vertexSource = shader_source;
+    return true;
+}
+
+bool ShaderUtils::Program::compileShader(const ShaderUtils::Type shader_type, const char *shader_source)
 {
     int success = {};
     char errorMessage[1024] = {};
@@ -30,16 +185,16 @@ bool ShaderUtils::Program::registerShader(const ShaderUtils::Type shader_type, c
 
     auto real_shader_type = !isFragmentShader ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER;
 
-    auto shader = glCreateShader(real_shader_type);
+    auto shader = GLUtils::gl().CreateShader(real_shader_type);
     // Now, pass the shaders
-    glShaderSource(shader, 1, &shader_source, NULL);
+    GLUtils::gl().ShaderSource(shader, 1, &shader_source, NULL);
     // And now, compile them
-    glCompileShader(shader);
+    GLUtils::gl().CompileShader(shader);
 
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    GLUtils::gl().GetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success)
     {
-        glGetShaderInfoLog(shader, 1024, NULL, errorMessage);
+        GLUtils::gl().GetShaderInfoLog(shader, 1024, NULL, errorMessage);
         if (isFragmentShader)
         {
             error("Fragment shader compilation error : " << errorMessage);
@@ -49,18 +204,16 @@ bool ShaderUtils::Program::registerShader(const ShaderUtils::Type shader_type, c
 
             error("Vertex shader compilation error : " << errorMessage);
         }
+        GLUtils::gl().DeleteShader(shader);
 
         return false;
     }
 
-    if (isFragmentShader)
-    {
-        fragmentShader = shader;
-    }
-    else
-    {
-        vertexShader = shader;
-    }
+    // A shader registered before and not linked yet is replaced
+    std::optional<unsigned int> &stage = isFragmentShader ? fragmentShader : vertexShader;
+    if (stage.has_value())
+        GLUtils::gl().DeleteShader(stage.value());
+    stage = shader;
     return true;
 }
 
@@ -71,10 +224,26 @@ bool ShaderUtils::Program::registerProgram(bool erase_if_registered)
         error("program is already registered");
         return false;
     }
-    if (registered && erase_if_registered)
+    uint64_t key = 0;
+    const bool cached = !cacheDirectory.empty();
+    if (cached)
     {
-        glDeleteProgram(program.value());
-        registered = false;
+        if (vertexSource.empty() || fragmentSource.empty())
+        {
+            error("cannot compile program without vertex and fragment shaders");
+            return false;
+        }
+        key = binaryKey(vertexSource, fragmentSource);
+        const unsigned int binaryProgram = loadBinary(key);
+        if (binaryProgram != 0)
+        {
+            replaceProgram(binaryProgram, true);
+            GLUtils::gl().UseProgram(binaryProgram);
+            return true;
+        }
+        if (!compileShader(ShaderUtils::Type::VERTEX_SHADER_TYPE, vertexSource.c_str()) ||
+            !compileShader(ShaderUtils::Type::FRAGMENT_SHADER_TYPE, fragmentSource.c_str()))
+            return false;
     }
     if (!vertexShader.has_value() || !fragmentShader.has_value())
     {
@@ -85,31 +254,231 @@ bool ShaderUtils::Program::registerProgram(bool erase_if_registered)
     char errorMessage[1024] = {};
     const unsigned int vertexShaderValue = vertexShader.value();
     const unsigned int fragmentShaderValue = fragmentShader.value();
+    // The shaders are used once, whether the link succeeds or not
+    vertexShader = std::nullopt;
+    fragmentShader = std::nullopt;
 
-    program = glCreateProgram();
-    const unsigned int programValue = program.value();
+    const unsigned int programValue = GLUtils::gl().CreateProgram();
+    GLUtils::gl().AttachShader(programValue, vertexShaderValue);
+    GLUtils::gl().AttachShader(programValue, fragmentShaderValue);
+    if (cached)
+        GLUtils::gl().ProgramParameteri(programValue, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    GLUtils::gl().LinkProgram(programValue);
 
-    glAttachShader(programValue, vertexShaderValue);
-    glAttachShader(programValue, fragmentShaderValue);
-    glLinkProgram(programValue);
-
-    glGetProgramiv(programValue, GL_LINK_STATUS, &success);
+    // We can now delete our vertex and fragment shaders
+    GLUtils::gl().DeleteShader(vertexShaderValue);
+    GLUtils::gl().DeleteShader(fragmentShaderValue);
+    GLUtils::gl().GetProgramiv(programValue, GL_LINK_STATUS, &success);
     if (!success)
     {
-        glGetProgramInfoLog(programValue, 1024, NULL, errorMessage);
+        // The registered program, if any, is kept
+        GLUtils::gl().GetProgramInfoLog(programValue, 1024, NULL, errorMessage);
         error("Shader linking error: " << errorMessage);
+        GLUtils::gl().DeleteProgram(programValue);
         return false;
     }
 
-    // We can now delete our vertex and fragment shaders
-    glDeleteShader(vertexShaderValue);
-    glDeleteShader(fragmentShaderValue);
-    glUseProgram(programValue);
-    registered = true;
+    replaceProgram(programValue, false);
+    GLUtils::gl().UseProgram(programValue);
+    if (cached)
+        saveBinary(key);
 
     return true;
 }
 
+void ShaderUtils::Program::replaceProgram(unsigned int linked, bool binary)
+{
+    if (registered && program.has_value())
+        GLUtils::gl().DeleteProgram(program.value());
+    program = linked;
+    registered = true;
+    fromBinaryCache = binary;
+    reflect();
+}
+
+uint64_t ShaderUtils::Program::binaryKey(std::string_view vertex_source, std::string_view fragment_source) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashBytes(hash, vertex_source.data(), vertex_source.size());
+    hash = hashBytes(hash, fragment_source.data(), fragment_source.size());
+    // A binary is only valid for the driver which made it
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const char *string = (const char *)GLUtils::gl().GetString(name);
+        hash = string ? hashBytes(hash, string, std::strlen(string)) : hashBytes(hash, "", 0);
+    }
+    return hash;
+}
+
+unsigned int ShaderUtils::Program::loadBinary(uint64_t key)
+{
+    GLint formats = 0;
+    GLUtils::gl().GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0)
+        return 0;
+    std::ifstream file(binaryPath(cacheDirectory, key), std::ios::binary);
+    uint32_t header[2] = {};
+    if (!file.read((char *)header, sizeof(header)) || header[0] != BINARY_MAGIC)
+        return 0;
+    std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (binary.empty())
+        return 0;
+
+    const unsigned int programValue = GLUtils::gl().CreateProgram();
+    GLUtils::gl().ProgramBinary(programValue, header[1], binary.data(), (GLsizei)binary.size());
+    int success = {};
+    GLUtils::gl().GetProgramiv(programValue, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        // Not an error: the driver may reject the binaries of its previous versions
+        debug("program binary " << std::hex << key << std::dec << " rejected, compiling");
+        GLUtils::gl().DeleteProgram(programValue);
+        return 0;
+    }
+    return programValue;
+}
+
+void ShaderUtils::Program::saveBinary(uint64_t key) const
+{
+    GLint formats = 0;
+    GLUtils::gl().GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    GLint length = 0;
+    GLUtils::gl().GetProgramiv(program.value(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (formats == 0 || length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLUtils::gl().GetProgramBinary(program.value(), length, &length, &format, binary.data());
+    if (length <= 0)
+        return;
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(cacheDirectory, errorCode);
+    // Written aside then renamed, so that a concurrent run never reads half a binary
+    const std::string path = binaryPath(cacheDirectory, key);
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        const uint32_t header[2] = {BINARY_MAGIC, format};
+        file.write((const char *)header, sizeof(header));
+        file.write(binary.data(), length);
+        if (!file)
+        {
+            warning("cannot write the program binary " << temporary);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, errorCode);
+    if (errorCode)
+        warning("cannot write the program binary " << path << ": " << errorCode.message());
+}
+
+void ShaderUtils::Program::submitProgram(std::string_view vertex_source, std::string_view fragment_source)
+{
+    discardPending();
+    if (!cacheDirectory.empty())
+    {
+        pendingKey = binaryKey(vertex_source, fragment_source);
+        const unsigned int binaryProgram = loadBinary(pendingKey);
+        if (binaryProgram != 0)
+        {
+            pendingProgram = binaryProgram;
+            return;
+        }
+    }
+
+    if (stageCache)
+    {
+        pendingVertexShader = stageCache->acquire(ShaderUtils::Type::VERTEX_SHADER_TYPE, vertex_source);
+        pendingFragmentShader = stageCache->acquire(ShaderUtils::Type::FRAGMENT_SHADER_TYPE, fragment_source);
+    }
+    else
+    {
+        // No status is queried here: that would wait for the driver
+        pendingVertexShader = GLUtils::gl().CreateShader(GL_VERTEX_SHADER);
+        compileSource(pendingVertexShader.value(), vertex_source);
+        pendingFragmentShader = GLUtils::gl().CreateShader(GL_FRAGMENT_SHADER);
+        compileSource(pendingFragmentShader.value(), fragment_source);
+    }
+
+    pendingProgram = GLUtils::gl().CreateProgram();
+    GLUtils::gl().AttachShader(pendingProgram.value(), pendingVertexShader.value());
+    GLUtils::gl().AttachShader(pendingProgram.value(), pendingFragmentShader.value());
+    if (!cacheDirectory.empty())
+        GLUtils::gl().ProgramParameteri(pendingProgram.value(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    GLUtils::gl().LinkProgram(pendingProgram.value());
+}
+
+ShaderUtils::ProgramStatus ShaderUtils::Program::pollProgram()
+{
+    if (!pendingProgram.has_value())
+        return ShaderUtils::PROGRAM_IDLE;
+    // A program restored from the cache is already linked
+    if (parallelCompile && pendingVertexShader.has_value())
+    {
+        int completed = {};
+        GLUtils::gl().GetProgramiv(pendingProgram.value(), GL_COMPLETION_STATUS_KHR, &completed);
+        if (!completed)
+            return ShaderUtils::PROGRAM_PENDING;
+    }
+    return finishProgram();
+}
+
+ShaderUtils::ProgramStatus ShaderUtils::Program::finishProgram()
+{
+    if (!pendingProgram.has_value())
+        return ShaderUtils::PROGRAM_IDLE;
+    const unsigned int programValue = pendingProgram.value();
+    const bool binary = !pendingVertexShader.has_value();
+    int success = {};
+    GLUtils::gl().GetProgramiv(programValue, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        logCompileError(pendingVertexShader.value(), "Vertex");
+        logCompileError(pendingFragmentShader.value(), "Fragment");
+        char errorMessage[1024] = {};
+        GLUtils::gl().GetProgramInfoLog(programValue, 1024, NULL, errorMessage);
+        error("Shader linking error: " << errorMessage);
+        discardPending();
+        return ShaderUtils::PROGRAM_FAILED;
+    }
+
+    pendingProgram = std::nullopt;
+    replaceProgram(programValue, binary);
+    if (!cacheDirectory.empty() && !binary)
+        saveBinary(pendingKey);
+    // The stages of the previous program are released, the new ones kept for the next reload
+    releaseShader(linkedVertexShader);
+    releaseShader(linkedFragmentShader);
+    if (stageCache)
+    {
+        std::swap(linkedVertexShader, pendingVertexShader);
+        std::swap(linkedFragmentShader, pendingFragmentShader);
+    }
+    discardPending();
+    return ShaderUtils::PROGRAM_READY;
+}
+
+void ShaderUtils::Program::discardPending()
+{
+    releaseShader(pendingVertexShader);
+    releaseShader(pendingFragmentShader);
+    if (pendingProgram.has_value())
+        GLUtils::gl().DeleteProgram(pendingProgram.value());
+    pendingProgram = std::nullopt;
+}
+
+void ShaderUtils::Program::releaseShader(std::optional<unsigned int> &shader)
+{
+    if (!shader.has_value())
+        return;
+    if (stageCache)
+        stageCache->release(shader.value());
+    else
+        GLUtils::gl().DeleteShader(shader.value());
+    shader = std::nullopt;
+}
+
 std::optional<unsigned int> ShaderUtils::Program::getProgram() const
 {
     return program;
@@ -119,3 +488,123 @@ bool ShaderUtils::Program::programIsRegistered() const
 {
     return registered;
 }
+
+bool ShaderUtils::Program::isFromBinaryCache() const
+{
+    return fromBinaryCache;
+}
+
+void ShaderUtils::Program::reflect()
+{
+    uniforms.clear();
+    uniformBlocks.clear();
+    const GLuint programValue = program.value();
+    GLchar name[256] = {};
+
+    GLint count = 0;
+    GLUtils::gl().GetProgramiv(programValue, GL_ACTIVE_UNIFORMS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        ShaderUtils::UniformInfo uniform = {"", -1, 0, 0};
+        GLUtils::gl().GetActiveUniform(programValue, i, sizeof(name), &length, &uniform.size, &uniform.type, name);
+        // Uniforms of a block have no location
+        uniform.location = GLUtils::gl().GetUniformLocation(programValue, name);
+        if (uniform.location < 0)
+            continue;
+        std::string_view key(name, length);
+        uniform.name = key;
+        if (!uniforms.emplace(ShaderUtils::hashName(key), uniform).second)
+            error("uniform " << key << " collides with another name, it can't be set by hash");
+        // Arrays are named `name[0]`, also registered as `name`
+        if (key.size() > 3 && key.substr(key.size() - 3) == "[0]")
+            uniforms.emplace(ShaderUtils::hashName(key.substr(0, key.size() - 3)), uniform);
+    }
+
+    GLUtils::gl().GetProgramiv(programValue, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        ShaderUtils::UniformBlockInfo block = {(GLuint)i, 0};
+        GLUtils::gl().GetActiveUniformBlockName(programValue, i, sizeof(name), &length, name);
+        GLUtils::gl().GetActiveUniformBlockiv(programValue, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+        std::string_view key(name, length);
+        if (!uniformBlocks.emplace(ShaderUtils::hashName(key), block).second)
+            error("uniform block " << key << " collides with another name, it can't be bound by hash");
+    }
+}
+
+const ShaderUtils::UniformInfo *ShaderUtils::Program::findUniform(uint32_t name) const
+{
+    auto uniform = uniforms.find(name);
+    return uniform != uniforms.end() ? &uniform->second : NULL;
+}
+
+const ShaderUtils::UniformBlockInfo *ShaderUtils::Program::findUniformBlock(uint32_t name) const
+{
+    auto block = uniformBlocks.find(name);
+    return block != uniformBlocks.end() ? &block->second : NULL;
+}
+
+GLint ShaderUtils::Program::getUniformLocation(uint32_t name) const
+{
+    const ShaderUtils::UniformInfo *uniform = findUniform(name);
+    return uniform ? uniform->location : -1;
+}
+
+GLint ShaderUtils::Program::typedLocation(uint32_t name, std::initializer_list<GLenum> types) const
+{
+    const ShaderUtils::UniformInfo *uniform = findUniform(name);
+    if (!uniform || !registered)
+        return -1;
+    for (GLenum type : types)
+        if (uniform->type == type)
+            return uniform->location;
+    error("uniform " << uniform->name << " has the GL type 0x" << std::hex << uniform->type << std::dec << ", not the type of the value");
+    return -1;
+}
+
+bool ShaderUtils::Program::setUniform(uint32_t name, GLint value) const
+{
+    const GLint location = typedLocation(name, {GL_INT, GL_BOOL, GL_SAMPLER_1D, GL_SAMPLER_2D, GL_SAMPLER_3D, GL_SAMPLER_CUBE, GL_SAMPLER_2D_ARRAY, GL_SAMPLER_BUFFER});
+    if (location < 0)
+        return false;
+    GLUtils::gl().ProgramUniform1i(program.value(), location, value);
+    return true;
+}
+
+bool ShaderUtils::Program::setUniform(uint32_t name, GLfloat value) const
+{
+    const GLint location = typedLocation(name, {GL_FLOAT});
+    if (location < 0)
+        return false;
+    GLUtils::gl().ProgramUniform1f(program.value(), location, value);
+    return true;
+}
+
+bool ShaderUtils::Program::setUniform(uint32_t name, const glm::vec2 &value) const
+{
+    const GLint location = typedLocation(name, {GL_FLOAT_VEC2});
+    if (location < 0)
+        return false;
+    GLUtils::gl().ProgramUniform2f(program.value(), location, value.x, value.y);
+    return true;
+}
+
+bool ShaderUtils::Program::setUniform(uint32_t name, const glm::mat4 &value) const
+{
+    const GLint location = typedLocation(name, {GL_FLOAT_MAT4});
+    if (location < 0)
+        return false;
+    GLUtils::gl().ProgramUniformMatrix4fv(program.value(), location, 1, GL_FALSE, &value[0][0]);
+    return true;
+}
+
+bool ShaderUtils::Program::bindUniformBlock(uint32_t name, GLuint binding) const
+{
+    auto block = uniformBlocks.find(name);
+    if (!registered || block == uniformBlocks.end())
+        return false;
+    GLUtils::gl().UniformBlockBinding(program.value(), block->second.index, binding);
+    return true;
+}
@@ -0,0 +1,103 @@
+#include "Base/state_cache.h"
+#include "Base/gl_dispatch.h"
+#include <cstring>
+
+bool StateUtils::StateCache::uniformChanged(GLint location, const void *value, std::size_t size)
+{
+    if (location < 0)
+    {
+        counters.elided++;
+        return false;
+    }
+    // Uniform values belong to the program
+    const uint64_t key = ((uint64_t)program << 32) | (uint32_t)location;
+    std::vector<unsigned char> &stored = uniforms[key];
+    if (stored.size() == size && std::memcmp(stored.data(), value, size) == 0)
+    {
+        counters.elided++;
+        return false;
+    }
+    stored.assign((const unsigned char *)value, (const unsigned char *)value + size);
+    counters.issued++;
+    return true;
+}
+
+void StateUtils::StateCache::useProgram(GLuint id)
+{
+    if (id == program)
+    {
+        counters.elided++;
+        return;
+    }
+    GLUtils::gl().UseProgram(id);
+    program = id;
+    counters.issued++;
+}
+
+void StateUtils::StateCache::bindVertexArray(GLuint id)
+{
+    if (id == vertexArray)
+    {
+        counters.elided++;
+        return;
+    }
+    GLUtils::gl().BindVertexArray(id);
+    vertexArray = id;
+    counters.issued++;
+}
+
+void StateUtils::StateCache::bindBuffer(GLenum target, GLuint id)
+{
+    std::unordered_map<GLuint, GLuint> &bindings = target == GL_ELEMENT_ARRAY_BUFFER ? elementBuffers : buffers;
+    const GLuint key = target == GL_ELEMENT_ARRAY_BUFFER ? vertexArray : target;
+    auto stored = bindings.find(key);
+    if (stored != bindings.end() && stored->second == id)
+    {
+        counters.elided++;
+        return;
+    }
+    GLUtils::gl().BindBuffer(target, id);
+    bindings[key] = id;
+    counters.issued++;
+}
+
+void StateUtils::StateCache::uniform1i(GLint location, GLint value)
+{
+    if (uniformChanged(location, &value, sizeof(value)))
+        GLUtils::gl().Uniform1i(location, value);
+}
+
+void StateUtils::StateCache::uniform1f(GLint location, GLfloat value)
+{
+    if (uniformChanged(location, &value, sizeof(value)))
+        GLUtils::gl().Uniform1f(location, value);
+}
+
+void StateUtils::StateCache::uniform2f(GLint location, GLfloat x, GLfloat y)
+{
+    const GLfloat value[2] = {x, y};
+    if (uniformChanged(location, value, sizeof(value)))
+        GLUtils::gl().Uniform2f(location, x, y);
+}
+
+void StateUtils::StateCache::uniformMatrix4(GLint location, const glm::mat4 &value)
+{
+    if (uniformChanged(location, &value[0][0], sizeof(value)))
+        GLUtils::gl().UniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+void StateUtils::StateCache::invalidate()
+{
+    // 0 is a valid binding: forget it by using an ID GL never returns
+    program = vertexArray = ~0u;
+    buffers.clear();
+    elementBuffers.clear();
+    uniforms.clear();
+}
+
+StateUtils::StateCounters StateUtils::StateCache::endFrame()
+{
+    StateCounters frame = counters;
+    counters = StateCounters();
+    return frame;
+}
@@ -0,0 +1,106 @@
+#include "Base/thread_pool.h"
+
+ThreadUtils::ThreadPool::ThreadPool(unsigned int workers)
+{
+    if (workers == 0)
+        workers = 1;
+    for (unsigned int i = 0; i < workers; i++)
+        queues.push_back(std::make_unique<Queue>());
+    for (unsigned int i = 0; i < workers; i++)
+        threads.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadUtils::ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+}
+
+void ThreadUtils::ThreadPool::submit(std::function<void()> task)
+{
+    pending++;
+    Queue &queue = *queues[next++ % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        // Counted once pushed, so that a woken worker finds it, and under the lock, so that
+        // a worker cannot go to sleep in between
+        std::lock_guard<std::mutex> lock(mutex);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+void ThreadUtils::ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]()
+              { return pending == 0; });
+}
+
+std::size_t ThreadUtils::ThreadPool::size() const
+{
+    return threads.size();
+}
+
+bool ThreadUtils::ThreadPool::pop(const std::size_t worker, std::function<void()> &task)
+{
+    // Own queue first, newest task
+    {
+        Queue &queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    // Then steal the oldest task of the other workers
+    for (std::size_t i = 1; i < queues.size(); i++)
+    {
+        Queue &queue = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadUtils::ThreadPool::run(const std::size_t worker)
+{
+    while (true)
+    {
+        std::function<void()> task;
+        if (pop(worker, task))
+        {
+            task();
+            if (--pending == 0)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this]()
+                  { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
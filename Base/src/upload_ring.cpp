@@ -0,0 +1,123 @@
+#include "Base/upload_ring.h"
+#include "Base/gl_dispatch.h"
+#include <cstring>
+
+GLUtils::UploadRing::UploadRing(GLsizeiptr frameSize, unsigned int frames)
+    : frameSize(frameSize), regionCount(frames > 0 ? frames : 1)
+{
+    GLUtils::gl().GenBuffers(1, &buffer);
+    GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, buffer);
+    if (GLUtils::gl().BufferStorage)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLUtils::gl().BufferStorage(GL_COPY_READ_BUFFER, frameSize * regionCount, NULL, flags);
+        mapped = (unsigned char *)GLUtils::gl().MapBufferRange(GL_COPY_READ_BUFFER, 0, frameSize * regionCount, flags);
+    }
+    if (!mapped)
+    {
+        regionCount = 1;
+        GLUtils::gl().BufferData(GL_COPY_READ_BUFFER, frameSize, NULL, GL_STREAM_DRAW);
+    }
+    GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, 0);
+    fences.resize(regionCount, nullptr);
+}
+
+GLUtils::UploadRing::~UploadRing()
+{
+    for (GLsync fence : fences)
+        if (fence)
+            GLUtils::gl().DeleteSync(fence);
+    if (mapped)
+    {
+        GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, buffer);
+        GLUtils::gl().UnmapBuffer(GL_COPY_READ_BUFFER);
+        GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    GLUtils::gl().DeleteBuffers(1, &buffer);
+}
+
+void GLUtils::UploadRing::beginFrame()
+{
+    used = 0;
+    if (!mapped)
+    {
+        // The driver gives the buffer new storage if the GPU still reads the previous one
+        GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, buffer);
+        GLUtils::gl().BufferData(GL_COPY_READ_BUFFER, frameSize, NULL, GL_STREAM_DRAW);
+        GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, 0);
+        return;
+    }
+    GLsync &fence = fences[region];
+    if (!fence)
+        return;
+    // Flushed once, so the fence gets signaled while we wait
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    GLenum status = GLUtils::gl().ClientWaitSync(fence, flags, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        waits++;
+        flags = 0;
+        while (status == GL_TIMEOUT_EXPIRED)
+            status = GLUtils::gl().ClientWaitSync(fence, flags, 1000000);
+    }
+    GLUtils::gl().DeleteSync(fence);
+    fence = nullptr;
+}
+
+bool GLUtils::UploadRing::write(const void *data, GLsizeiptr size, GLsizeiptr alignment, GLintptr &offset)
+{
+    const GLsizeiptr start = alignment > 1 ? (used + alignment - 1) / alignment * alignment : used;
+    if (start + size > frameSize)
+        return false;
+    const GLintptr rangeOffset = region * frameSize + start;
+    if (mapped)
+    {
+        std::memcpy(mapped + rangeOffset, data, size);
+        used = start + size;
+        offset = rangeOffset;
+        return true;
+    }
+
+    // Nothing reads this range of the new storage yet
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, buffer);
+    void *range = GLUtils::gl().MapBufferRange(GL_COPY_READ_BUFFER, rangeOffset, size, access);
+    bool written = false;
+    if (range)
+    {
+        std::memcpy(range, data, size);
+        // The contents are undefined if the storage was lost while mapped
+        written = GLUtils::gl().UnmapBuffer(GL_COPY_READ_BUFFER) == GL_TRUE;
+    }
+    GLUtils::gl().BindBuffer(GL_COPY_READ_BUFFER, 0);
+    // A failed write leaves the space of the frame to the next ones
+    if (written)
+    {
+        used = start + size;
+        offset = rangeOffset;
+    }
+    return written;
+}
+
+void GLUtils::UploadRing::endFrame()
+{
+    if (!mapped)
+        return;
+    fences[region] = GLUtils::gl().FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % regionCount;
+}
+
+GLuint GLUtils::UploadRing::getBuffer() const
+{
+    return buffer;
+}
+
+bool GLUtils::UploadRing::isPersistent() const
+{
+    return mapped != nullptr;
+}
+
+std::size_t GLUtils::UploadRing::getWaits() const
+{
+    return waits;
+}
@@ -0,0 +1,38 @@
+#version 330 core
+
+// A LineUtils::CompactLineVertex and its neighbours, read from the same buffer: the position in
+// the bounding box of the chunk, then direction * (0.5 + 0.5 * arc length in the chunk)
+layout(location = 0) in vec4 position;
+layout(location = 2) in vec4 next;
+layout(location = 3) in vec4 previous;
+
+out float lineDistance;
+
+uniform mat4 projection;
+uniform mat4 model;
+uniform mat4 view;
+uniform float aspect;
+
+uniform float thickness;
+// Per chunk, LineUtils::packChunks: 5 texels, the dequantization, then the arc length of the first
+// point of the chunk and the one it adds. All the chunks are drawn at once, the chunk of a
+// vertex is found from its index, which includes the base vertex of its draw.
+uniform samplerBuffer chunks;
+uniform int chunkVertices;
+
+// expandLine, see ShaderUtils::Preprocessor
+#include "line_expand.glsl"
+
+void main() {
+  int chunk = gl_VertexID / chunkVertices * 5;
+  mat4 dequantize = mat4(texelFetch(chunks, chunk), texelFetch(chunks, chunk + 1), texelFetch(chunks, chunk + 2), texelFetch(chunks, chunk + 3));
+  vec2 distanceRange = texelFetch(chunks, chunk + 4).xy;
+
+  mat4 projViewModel = projection * view * model * dequantize;
+  vec4 previousProjected = projViewModel * vec4(previous.xyz, 1.0);
+  vec4 currentProjected = projViewModel * vec4(position.xyz, 1.0);
+  vec4 nextProjected = projViewModel * vec4(next.xyz, 1.0);
+
+  gl_Position = expandLine(previousProjected, currentProjected, nextProjected, sign(position.w), aspect, thickness);
+  lineDistance = distanceRange.x + (abs(position.w) * 2.0 - 1.0) * distanceRange.y;
+}
@@ -1,8 +1,21 @@
 #version 330 core
 
+in float lineDistance;
+
+#ifdef LINE_DASH
+// 16-bit stipple pattern, each bit covering `factor` units of arc length
+uniform int pattern;
+uniform float factor;
+#endif
+
 out vec4 fragColor;
 
 void main()
 {
+#ifdef LINE_DASH
+    int bit = int(mod(lineDistance / factor, 16.0));
+    if ((pattern & (1 << bit)) == 0)
+        discard;
+#endif
     fragColor = vec4(1.0);
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+#version 330 core
+
+// One instance per segment: the four points around it, w holding the arc length
+layout(location = 0) in vec4 previous;
+layout(location = 1) in vec4 start;
+layout(location = 2) in vec4 end;
+layout(location = 3) in vec4 next;
+
+out float lineDistance;
+
+uniform mat4 projection;
+uniform mat4 model;
+uniform mat4 view;
+uniform float aspect;
+
+uniform float thickness;
+
+// expandLine, see ShaderUtils::Preprocessor
+#include "line_expand.glsl"
+
+void main() {
+  // Triangle strip: (start, -1), (start, 1), (end, -1), (end, 1)
+  bool atEnd = gl_VertexID >= 2;
+  float orientation = (gl_VertexID & 1) == 0 ? -1.0 : 1.0;
+  vec3 before = atEnd ? start.xyz : previous.xyz;
+  vec4 current = atEnd ? end : start;
+  vec3 after = atEnd ? next.xyz : end.xyz;
+
+  mat4 projViewModel = projection * view * model;
+  vec4 previousProjected = projViewModel * vec4(before, 1.0);
+  vec4 currentProjected = projViewModel * vec4(current.xyz, 1.0);
+  vec4 nextProjected = projViewModel * vec4(after, 1.0);
+
+  gl_Position = expandLine(previousProjected, currentProjected, nextProjected, orientation, aspect, thickness);
+  lineDistance = current.w;
+}
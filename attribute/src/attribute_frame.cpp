@@ -0,0 +1,386 @@
+#include "attribute_frame.h"
+#include "../../glm/glm/gtc/matrix_transform.hpp"
+#include "../../glm/glm/gtx/string_cast.hpp"
+#include <Base/logs.h>
+#include <Base/maths_utils.h>
+#include <Base/line_utils.h>
+#include <Base/line_style.h>
+#include <Base/line_quantize.h>
+#include <Base/gl_dispatch.h>
+#include <Base/gl_check.h>
+#include <iostream>
+#include <cstddef>
+#include <math.h>
+
+// Set on each program linked, see setUniforms
+const float thickness = 0.3f;
+// Dashes along the arc length, one pattern bit every `factor` model units
+const GLushort dashPattern = 0x18ff;
+const GLushort solidPattern = 0xffff;
+const GLfloat factor = 0.05f;
+// Each frame draws the coarsest simplification of the path under this error
+const float LOD_PIXEL_ERROR = 0.5f;
+// The telemetry points streamed, one per frame
+const size_t TELEMETRY_POINTS = 600;
+const int FIELD_WAVES = 16;
+
+// The uniforms of the shaders, looked up in the reflection of the program
+constexpr uint32_t U_MODEL = ShaderUtils::hashName("model");
+constexpr uint32_t U_PROJECTION = ShaderUtils::hashName("projection");
+constexpr uint32_t U_VIEW = ShaderUtils::hashName("view");
+constexpr uint32_t U_THICKNESS = ShaderUtils::hashName("thickness");
+constexpr uint32_t U_ASPECT = ShaderUtils::hashName("aspect");
+constexpr uint32_t U_PATTERN = ShaderUtils::hashName("pattern");
+constexpr uint32_t U_FACTOR = ShaderUtils::hashName("factor");
+constexpr uint32_t U_CHUNKS = ShaderUtils::hashName("chunks");
+constexpr uint32_t U_CHUNK_VERTICES = ShaderUtils::hashName("chunkVertices");
+
+/**
+ * @brief Points the attributes of the bound VAO to an interleaved LineUtils::LineVertex buffer
+ *
+ * @param buffer The vertex buffer ID
+ */
+static void setupLineAttributes(const GLuint buffer)
+{
+    const GLsizei stride = sizeof(LineUtils::LineVertex);
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, buffer));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(LineUtils::LineVertex, position)));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(0));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(LineUtils::LineVertex, direction)));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(1));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(LineUtils::LineVertex, next)));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(2));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(LineUtils::LineVertex, previous)));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(3));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(LineUtils::LineVertex, distance)));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(4));
+}
+
+/**
+ * @brief Points the attributes of the bound VAO to a LineUtils::expandAliased buffer:
+ * position, previous and next read the same vertices, ALIASED_LINE_PADDING apart
+ *
+ * @param buffer The vertex buffer ID
+ */
+static void setupAliasedLineAttributes(const GLuint buffer)
+{
+    const GLsizei stride = sizeof(LineUtils::AliasedLineVertex);
+    const size_t current = LineUtils::ALIASED_LINE_PADDING * stride;
+    const size_t position = offsetof(LineUtils::AliasedLineVertex, position);
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, buffer));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)(current + position)));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(0));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, stride, (void*)(current + offsetof(LineUtils::AliasedLineVertex, direction))));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(1));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(2 * current + position)));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(2));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)position));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(3));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride, (void*)(current + offsetof(LineUtils::AliasedLineVertex, distance))));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(4));
+}
+
+/**
+ * @brief Points the attributes of the bound VAO to a LineUtils::expandInstanced buffer:
+ * previous, start, end and next are the same points, one apart, advanced once per instance
+ *
+ * @param buffer The vertex buffer ID
+ */
+static void setupSegmentAttributes(const GLuint buffer)
+{
+    const GLsizei stride = sizeof(glm::vec4);
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, buffer));
+    for (GLuint location = 0; location < 4; location++)
+    {
+        GL_CHECK(GLUtils::gl().VertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void*)(location * sizeof(glm::vec4))));
+        GL_CHECK(GLUtils::gl().VertexAttribDivisor(location, 1));
+        GL_CHECK(GLUtils::gl().EnableVertexAttribArray(location));
+    }
+}
+
+/**
+ * @brief Points the attributes of the bound VAO to a LineUtils::quantize buffer: position,
+ * previous and next read the same vertices, ALIASED_LINE_PADDING apart
+ *
+ * @param buffer The vertex buffer ID
+ * @param format The format of the components
+ */
+static void setupCompactLineAttributes(const GLuint buffer, const LineUtils::QuantizedFormat format)
+{
+    const GLsizei stride = sizeof(LineUtils::CompactLineVertex);
+    const size_t current = LineUtils::ALIASED_LINE_PADDING * stride;
+    // Signed normalized integers read as [-1, 1], half floats as is
+    const GLenum type = format == LineUtils::HALF_FORMAT ? GL_HALF_FLOAT : GL_SHORT;
+    const GLboolean normalized = format == LineUtils::HALF_FORMAT ? GL_FALSE : GL_TRUE;
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, buffer));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(0, 4, type, normalized, stride, (void*)current));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(0));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(2, 4, type, normalized, stride, (void*)(2 * current)));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(2));
+    GL_CHECK(GLUtils::gl().VertexAttribPointer(3, 4, type, normalized, stride, (void*)0));
+    GL_CHECK(GLUtils::gl().EnableVertexAttribArray(3));
+}
+
+AttributeFrame::AttributeFrame()
+    : uploadRing(64 * 1024)
+{
+    view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
+
+    ////////////////////////////// path setting ////////////////////////////
+    std::vector<glm::vec3> path;
+    path.push_back({0, -1, 0});
+    path.push_back({1, -1, 0});
+    path.push_back({0, 0, 0});
+    path.push_back({1, 0, 0});
+    path.push_back({0.25, -0.75, 0});
+
+    // Round joins and caps instead of unbounded miters on the sharp turns of the path
+    LineUtils::LineStyle style;
+    style.join = LineUtils::ROUND_JOIN;
+    style.cap = LineUtils::ROUND_CAP;
+    LineUtils::StyledLine styledPath;
+    LineUtils::tessellate(path.data(), path.size(), style, styledPath);
+
+    // Simplifications of the path: each frame draws the coarsest one under LOD_PIXEL_ERROR.
+    // Their styled meshes follow the full one (level 0) in the buffers, one index range each.
+    pathLod.build(path.data(), path.size());
+    std::vector<LineUtils::LineVertex> vertices = styledPath.vertices;
+    std::vector<uint32_t> pathIndices = styledPath.indices;
+    lodCounts = {(GLsizei)pathIndices.size()};
+    lodFirsts = {0};
+    for (size_t level = 1; level < pathLod.getLevelCount(); level++)
+    {
+        const std::vector<glm::vec3> &points = pathLod.getLevel(level).points;
+        LineUtils::StyledLine styledLevel;
+        LineUtils::tessellate(points.data(), points.size(), style, styledLevel);
+        lodFirsts.push_back(pathIndices.size());
+        lodCounts.push_back((GLsizei)styledLevel.indices.size());
+        const uint32_t base = (uint32_t)vertices.size();
+        for (uint32_t index : styledLevel.indices)
+            pathIndices.push_back(base + index);
+        vertices.insert(vertices.end(), styledLevel.vertices.begin(), styledLevel.vertices.end());
+    }
+
+    // Bounding boxes of the path chunks, to only draw the visible ones
+    chunkedPath.build(path.data(), path.size(), LineUtils::LINE_CHUNK_SEGMENTS, styledPath.segmentIndices.data());
+
+    // 16-bit indices while the vertices fit, 32-bit ones for long paths
+    indexType = MathsUtils::indexType(vertices.size());
+    std::vector<GLushort> indices16;
+    if (indexType == GL_UNSIGNED_SHORT)
+        indices16.assign(pathIndices.begin(), pathIndices.end());
+    const void *indices = indexType == GL_UNSIGNED_SHORT ? (const void *)indices16.data() : (const void *)pathIndices.data();
+    indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    GLsizeiptr indicesSize = pathIndices.size() * indexSize;
+    //////////////////////////////////////////////////////////////////////////////////////////
+
+    GLuint VBO = 0;
+    GLuint IBO = 0;
+
+    GL_CHECK(GLUtils::gl().GenBuffers(1, &VBO));
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, VBO));
+    GL_CHECK(GLUtils::gl().BufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(*vertices.data()), vertices.data(), GL_STATIC_DRAW));
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, 0));
+
+    GL_CHECK(GLUtils::gl().GenBuffers(1, &IBO));
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO));
+    GL_CHECK(GLUtils::gl().BufferData(GL_ELEMENT_ARRAY_BUFFER, indicesSize, indices, GL_STATIC_DRAW));
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+    GL_CHECK(GLUtils::gl().GenVertexArrays(1, &pathVAO));
+    GL_CHECK(GLUtils::gl().BindVertexArray(pathVAO));
+
+    setupLineAttributes(VBO);
+
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO));
+    GL_CHECK(GLUtils::gl().BindVertexArray(0));
+
+    // The same path as instanced segments: 4 floats per point, no index buffer
+    std::vector<glm::vec4> segmentPoints(LineUtils::instancedSize(path.size()));
+    LineUtils::expandInstanced(path.data(), path.size(), segmentPoints.data());
+    segmentCount = path.size() > 1 ? (GLsizei)path.size() - 1 : 0;
+    GLuint segmentVBO = 0;
+    GL_CHECK(GLUtils::gl().GenBuffers(1, &segmentVBO));
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, segmentVBO));
+    GL_CHECK(GLUtils::gl().BufferData(GL_ARRAY_BUFFER, segmentPoints.size() * sizeof(glm::vec4), segmentPoints.data(), GL_STATIC_DRAW));
+    GL_CHECK(GLUtils::gl().GenVertexArrays(1, &segmentVAO));
+    GL_CHECK(GLUtils::gl().BindVertexArray(segmentVAO));
+    setupSegmentAttributes(segmentVBO);
+    GL_CHECK(GLUtils::gl().BindVertexArray(0));
+
+    // The same path quantized to 16 bits against the bounding box of each chunk
+    LineUtils::QuantizedLine quantizedPath;
+    LineUtils::quantize(path.data(), path.size(), LineUtils::SNORM16_FORMAT, LineUtils::LINE_CHUNK_SEGMENTS, quantizedPath);
+    GLuint quantizedBuffers[2] = {0, 0};
+    GL_CHECK(GLUtils::gl().GenBuffers(2, quantizedBuffers));
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ARRAY_BUFFER, quantizedBuffers[0]));
+    GL_CHECK(GLUtils::gl().BufferData(GL_ARRAY_BUFFER, quantizedPath.vertices.size() * sizeof(LineUtils::CompactLineVertex), quantizedPath.vertices.data(), GL_STATIC_DRAW));
+    GL_CHECK(GLUtils::gl().GenVertexArrays(1, &quantizedVAO));
+    GL_CHECK(GLUtils::gl().BindVertexArray(quantizedVAO));
+    setupCompactLineAttributes(quantizedBuffers[0], quantizedPath.format);
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, quantizedBuffers[1]));
+    GL_CHECK(GLUtils::gl().BufferData(GL_ELEMENT_ARRAY_BUFFER, quantizedPath.indices.size() * sizeof(uint16_t), quantizedPath.indices.data(), GL_STATIC_DRAW));
+    GL_CHECK(GLUtils::gl().BindVertexArray(0));
+    // What each chunk is drawn with, in a texture buffer: one draw call for all the chunks
+    std::vector<glm::vec4> chunkTexels;
+    LineUtils::packChunks(quantizedPath, chunkTexels);
+    GLuint chunkBuffer = 0;
+    GLuint chunkTexture = 0;
+    GL_CHECK(GLUtils::gl().GenBuffers(1, &chunkBuffer));
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_TEXTURE_BUFFER, chunkBuffer));
+    GL_CHECK(GLUtils::gl().BufferData(GL_TEXTURE_BUFFER, chunkTexels.size() * sizeof(glm::vec4), chunkTexels.data(), GL_STATIC_DRAW));
+    GL_CHECK(GLUtils::gl().GenTextures(1, &chunkTexture));
+    GL_CHECK(GLUtils::gl().BindTexture(GL_TEXTURE_BUFFER, chunkTexture));
+    GL_CHECK(GLUtils::gl().TexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, chunkBuffer));
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_TEXTURE_BUFFER, 0));
+    LineUtils::drawChunks(quantizedPath, chunkDraws);
+    chunkVertices = (GLint)quantizedPath.chunkVertices;
+    for (const LineUtils::QuantizedChunk &chunk : quantizedPath.chunks)
+        info("quantized chunk " << chunk.firstSegment << "+" << chunk.segmentCount << ": "
+                                << chunk.positionError << " position error, " << chunk.distanceError << " distance error");
+
+    info("path: " << vertices.size() * sizeof(LineUtils::LineVertex) + indicesSize << " bytes styled, "
+                  << segmentPoints.size() * sizeof(glm::vec4) << " bytes instanced, "
+                  << quantizedPath.vertices.size() * sizeof(LineUtils::CompactLineVertex) + quantizedPath.indices.size() * sizeof(uint16_t) << " bytes quantized");
+
+    // Streamed telemetry: one point is appended per frame, only the new segment is uploaded,
+    // staged in the ring so the driver doesn't wait for the draws still reading the buffers.
+    // Its previous and next attributes alias the positions: 5 floats per vertex instead of 11
+    glm::vec3 telemetryStart(-2.0f, 1.0f, 0.0f);
+    telemetry.append(&telemetryStart, 1);
+    telemetry.upload();
+
+    GL_CHECK(GLUtils::gl().GenVertexArrays(1, &telemetryVAO));
+    GL_CHECK(GLUtils::gl().BindVertexArray(telemetryVAO));
+    setupAliasedLineAttributes(telemetry.getVertexBuffer());
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, telemetry.getIndexBuffer()));
+    GL_CHECK(GLUtils::gl().BindVertexArray(0));
+
+    // A field of small waves in a single pool: one VAO and one draw call for all of them
+    for (int wave = 0; wave < FIELD_WAVES; wave++)
+    {
+        std::vector<glm::vec3> wavePoints;
+        for (int i = 0; i < 32; i++)
+            wavePoints.push_back({-2.0f + 4.0f * i / 31, -1.2f - 0.1f * wave + 0.03f * sinf(0.4f * i + wave), 0.0f});
+        field.addPolyline(wavePoints.data(), wavePoints.size());
+    }
+    GL_CHECK(field.upload());
+    field.drawAll(fieldDraws);
+
+    GL_CHECK(GLUtils::gl().GenVertexArrays(1, &fieldVAO));
+    GL_CHECK(GLUtils::gl().BindVertexArray(fieldVAO));
+    setupLineAttributes(field.getVertexBuffer());
+    GL_CHECK(GLUtils::gl().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, field.getIndexBuffer()));
+    GL_CHECK(GLUtils::gl().BindVertexArray(0));
+
+    GL_CHECK(GLUtils::gl().ClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+}
+
+void AttributeFrame::createPrograms(ShaderUtils::PermutationCache &permutations)
+{
+    const ShaderUtils::Defines miter = {{"LINE_MITER", ""}};
+    const ShaderUtils::Defines dash = {{"LINE_DASH", ""}};
+    pathProgram = &permutations.get("vertex_shader.glsl", "fragment_shader.glsl", miter, dash);
+    solidProgram = &permutations.get("vertex_shader.glsl", "fragment_shader.glsl", miter);
+    segmentProgram = &permutations.get("segment_vertex_shader.glsl", "fragment_shader.glsl", miter, dash);
+    compactProgram = &permutations.get("compact_vertex_shader.glsl", "fragment_shader.glsl", miter, dash);
+}
+
+void AttributeFrame::setUniforms() const
+{
+    // A reload links new programs: their uniforms start from their defaults
+    for (const ShaderUtils::Program *program : {pathProgram, solidProgram, segmentProgram, compactProgram})
+    {
+        GL_CHECK(program->setUniform(U_THICKNESS, thickness));
+        GL_CHECK(program->setUniform(U_FACTOR, factor));
+        // The chunk table stays bound to the unit 0
+        GL_CHECK(program->setUniform(U_CHUNKS, (GLint)0));
+        GL_CHECK(program->setUniform(U_CHUNK_VERTICES, chunkVertices));
+    }
+}
+
+void AttributeFrame::useLineProgram(StateUtils::StateCache &state, const ShaderUtils::Program &program, const glm::mat4 &model, GLushort pattern) const
+{
+    GL_CHECK(state.useProgram(program.getProgram().value()));
+    GL_CHECK(state.uniform1f(program.getUniformLocation(U_ASPECT), aspect));
+    GL_CHECK(state.uniformMatrix4(program.getUniformLocation(U_PROJECTION), projection));
+    GL_CHECK(state.uniformMatrix4(program.getUniformLocation(U_VIEW), view));
+    GL_CHECK(state.uniformMatrix4(program.getUniformLocation(U_MODEL), model));
+    GL_CHECK(state.uniform1i(program.getUniformLocation(U_PATTERN), pattern));
+}
+
+void AttributeFrame::draw(StateUtils::StateCache &state, int width, int height, float time, bool instanced, bool quantized)
+{
+    if (width != viewport[0] || height != viewport[1])
+    {
+        viewport[0] = width; viewport[1] = height;
+        GL_CHECK(GLUtils::gl().Viewport(0, 0, viewport[0], viewport[1]));
+        aspect = (float)width/(float)height;
+        projection = glm::perspective((float)M_PI/4, aspect, 0.0f, 1000.0f);
+        std::cout << glm::to_string(projection) << std::endl;
+        std::cout << "vpSize[0] = " << viewport[0] << ", vpSize[1] = " << viewport[1] << ", aspect = " << aspect << std::endl;
+    }
+
+    uploadRing.beginFrame();
+    GL_CHECK(GLUtils::gl().Clear(GL_COLOR_BUFFER_BIT));
+    GL_CHECK(GLUtils::gl().PolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+
+    const glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(time * 10.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    if (quantized)
+    {
+        // Miter joins only, every chunk in one draw: the shader reads their dequantization
+        useLineProgram(state, *compactProgram, rotation, dashPattern);
+        GL_CHECK(state.bindVertexArray(quantizedVAO));
+        GL_CHECK(GLUtils::gl().MultiDrawElementsBaseVertex(GL_TRIANGLES, chunkDraws.counts.data(), GL_UNSIGNED_SHORT, chunkDraws.offsets.data(), chunkDraws.size(), chunkDraws.baseVertices.data()));
+    }
+    else if (instanced)
+    {
+        // Miter joins only, and every segment is drawn: the chunks index the styled mesh
+        useLineProgram(state, *segmentProgram, rotation, dashPattern);
+        GL_CHECK(state.bindVertexArray(segmentVAO));
+        GL_CHECK(GLUtils::gl().DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, (GLsizei)LineUtils::SEGMENT_INSTANCE_VERTICES, segmentCount));
+    }
+    else
+    {
+        useLineProgram(state, *pathProgram, rotation, dashPattern);
+        GL_CHECK(state.bindVertexArray(pathVAO));
+        const glm::mat4 pathMvp = projection * view * rotation;
+        const size_t level = pathLod.selectLevel(pathMvp, glm::vec2((float)width, (float)height), LOD_PIXEL_ERROR);
+        if (level != pathLevel)
+        {
+            debug("path level " << level << ": " << pathLod.getLevel(level).points.size() << " points");
+            pathLevel = level;
+        }
+        if (level == 0)
+        {
+            // The shader pushes the vertices by up to MITER_LIMIT / 2 thicknesses, and adds 1 to w
+            GLsizei ranges = chunkedPath.cull(pathMvp, 2.0f * thickness + 1.0f, indexType, chunkCounts, chunkOffsets);
+            GL_CHECK(GLUtils::gl().MultiDrawElements(GL_TRIANGLES, chunkCounts.data(), indexType, chunkOffsets.data(), ranges));
+        }
+        else
+        {
+            // The chunks bound the full path only: a simplified one is drawn whole
+            GL_CHECK(GLUtils::gl().DrawElements(GL_TRIANGLES, lodCounts[level], indexType, (const void *)(lodFirsts[level] * indexSize)));
+        }
+    }
+
+    size_t received = telemetry.getPoints().size();
+    if (received < TELEMETRY_POINTS)
+    {
+        glm::vec3 sample(-2.0f + 4.0f * received / TELEMETRY_POINTS, 1.0f + 0.25f * sinf(received * 0.1f), 0.0f);
+        telemetry.append(&sample, 1);
+        GL_CHECK(telemetry.upload(&uploadRing));
+    }
+    useLineProgram(state, *solidProgram, glm::mat4(1.0f), solidPattern);
+    GL_CHECK(state.bindVertexArray(telemetryVAO));
+    GL_CHECK(GLUtils::gl().DrawElements(GL_TRIANGLES, telemetry.getIndexCount(), GL_UNSIGNED_INT, nullptr));
+
+    GL_CHECK(state.bindVertexArray(fieldVAO));
+    GL_CHECK(GLUtils::gl().MultiDrawElementsBaseVertex(GL_TRIANGLES, fieldDraws.counts.data(), GL_UNSIGNED_INT, fieldDraws.offsets.data(), fieldDraws.size(), fieldDraws.baseVertices.data()));
+    uploadRing.endFrame();
+}
+
+std::size_t AttributeFrame::getUploadWaits() const
+{
+    return uploadRing.getWaits();
+}
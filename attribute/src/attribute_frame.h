@@ -0,0 +1,126 @@
+#ifndef _ATTRIBUTE_FRAME_H
+#define _ATTRIBUTE_FRAME_H
+
+#include <cstddef>
+#include <vector>
+#include "../../glm/glm/glm.hpp"
+#include <Base/shader_utils.h>
+#include <Base/shader_preprocessor.h>
+#include <Base/line_lod.h>
+#include <Base/line_chunks.h>
+#include <Base/live_polyline.h>
+#include <Base/line_pool.h>
+#include <Base/state_cache.h>
+#include <Base/upload_ring.h>
+
+/**
+ * @brief The scene of the attribute demo: the styled path with its simplifications, culled in
+ * chunks, also drawn from instanced segments or quantized chunks, the streamed telemetry and a
+ * field of waves. Every GL call goes through GLUtils::gl(): the benchmark records these frames.
+ */
+struct AttributeFrame
+{
+
+private:
+    /**
+     * @brief The path dashed, the telemetry and the field solid, see `createPrograms`
+     */
+    ShaderUtils::Program *pathProgram = nullptr;
+    ShaderUtils::Program *solidProgram = nullptr;
+    ShaderUtils::Program *segmentProgram = nullptr;
+    ShaderUtils::Program *compactProgram = nullptr;
+
+    /**
+     * @brief The styled path and its simplifications, one index range each, in `pathVAO`
+     */
+    GLuint pathVAO = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    std::size_t indexSize = sizeof(GLuint);
+    LineUtils::LodHierarchy pathLod;
+    std::vector<GLsizei> lodCounts;
+    std::vector<std::size_t> lodFirsts;
+    std::size_t pathLevel = 0;
+
+    /**
+     * @brief The chunks of the full path, and the ranges of the visible ones
+     */
+    LineUtils::ChunkedLine chunkedPath;
+    std::vector<GLsizei> chunkCounts;
+    std::vector<const void *> chunkOffsets;
+
+    /**
+     * @brief The path as instanced segments, and as quantized chunks drawn in one call
+     */
+    GLuint segmentVAO = 0;
+    GLsizei segmentCount = 0;
+    GLuint quantizedVAO = 0;
+    GLint chunkVertices = 0;
+    LineUtils::PoolDrawList chunkDraws;
+
+    /**
+     * @brief The telemetry, one point streamed per frame through the ring
+     */
+    GLUtils::UploadRing uploadRing;
+    LineUtils::LivePolyline telemetry;
+    GLuint telemetryVAO = 0;
+
+    /**
+     * @brief The waves, in a single pool
+     */
+    LineUtils::LinePool field;
+    LineUtils::PoolDrawList fieldDraws;
+    GLuint fieldVAO = 0;
+
+    /**
+     * @brief The framebuffer size the projection was computed for
+     */
+    int viewport[2] = {0, 0};
+    float aspect = 1.0f;
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::mat4 view = glm::mat4(1.0f);
+
+    /**
+     * @brief Uses one of the programs with the uniforms of a draw, sent only if they changed
+     */
+    void useLineProgram(StateUtils::StateCache &state, const ShaderUtils::Program &program, const glm::mat4 &model, GLushort pattern) const;
+
+public:
+    /**
+     * @brief Constructor, creates the buffers and the vertex arrays: a context must be current,
+     * or the calls recorded
+     */
+    AttributeFrame();
+
+    AttributeFrame(const AttributeFrame &) = delete;
+    AttributeFrame &operator=(const AttributeFrame &) = delete;
+
+    /**
+     * @brief Submits the programs to a cache whose preprocessor loads the demo's shaders: the
+     * joins are mitered, and only the path is dashed
+     */
+    void createPrograms(ShaderUtils::PermutationCache &permutations);
+
+    /**
+     * @brief Sets the uniforms which don't change between frames, once the programs are linked
+     */
+    void setUniforms() const;
+
+    /**
+     * @brief Draws a frame, after the programs are linked
+     *
+     * @param state - the state cache, which elides the calls repeated since the last frame
+     * @param width - the width of the framebuffer, the viewport and projection follow it
+     * @param height - the height of the framebuffer
+     * @param time - the time animating the path, in seconds
+     * @param instanced - draws the path from instanced segments rather than its styled mesh
+     * @param quantized - draws the path from its quantized chunks, before `instanced`
+     */
+    void draw(StateUtils::StateCache &state, int width, int height, float time, bool instanced, bool quantized);
+
+    /**
+     * @brief Returns how many times the telemetry upload waited for the GPU
+     */
+    std::size_t getUploadWaits() const;
+};
+
+#endif /* _ATTRIBUTE_FRAME_H */
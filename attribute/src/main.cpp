@@ -10,32 +10,35 @@
 
 #include <vector>
 #include <string>
-#include "../../glm/glm/glm.hpp"
-#include "../../glm/glm/gtc/matrix_transform.hpp"
-#include "../../glm/glm/gtc/type_ptr.hpp"
-#include "../../glm/glm/gtx/string_cast.hpp"
 #include <Base/logs.h>
 #include <Base/shader_utils.h>
-#include <Base/maths_utils.h>
+#include <Base/shader_preprocessor.h>
+#include <Base/shader_loader.h>
+#include <Base/file_watcher.h>
+#include <Base/state_cache.h>
+#include <Base/headless.h>
+#include <Base/gl_dispatch.h>
+#include <Base/gl_check.h>
+#include "attribute_frame.h"
+#include "embedded_shaders.h"
 #include <iostream>
-#include <fstream>
-#include <math.h>
-
-#define STRING(x) #x
-
-#define GL_TEST(function) do { \
-    function; \
-    GLenum error = glGetError(); \
-    if (error != GL_NO_ERROR) { \
-        std::cout << "\e[0;31m" << "|ERROR| " << STRING(function) << std::endl << "|ERROR| error code : " << error << "\e[0m" << std::endl; \
-        throw std::runtime_error("Err to call GL function."); \
-    } \
-} while(false)
+#include <cstddef>
+#include <optional>
 
 const size_t WIDTH = 1080;
 const size_t HEIGHT = 1920;
 const char *WINDOW_NAME = "OpenGL";
-auto shader_utils = ShaderUtils::Program{};
+// The shaders embedded at build time, overridden by their files in the source tree once saved
+auto shader_loader = ShaderUtils::ShaderLoader(EmbeddedShaders::FILES, HOME_PATH "/attribute/shaders");
+// The programs of the frame, compiled from the shaders with the features of their draws
+auto permutations = ShaderUtils::PermutationCache{};
+auto state_cache = StateUtils::StateCache{};
+// Set when a program is linked, whose uniforms must be set again
+bool program_linked = true;
+// Switched with the 'i' key: the path drawn from instanced segments rather than its styled mesh
+bool instanced_mode = false;
+// Switched with the 'q' key: the path drawn from its quantized chunks, before the modes above
+bool quantized_mode = false;
 
 /*
  * Callback to handle the "close window" event, once the user pressed the Escape key.
@@ -47,13 +50,13 @@ static void quitCallback(GLFWwindow *window, int key, int scancode, int action,
 }
 
 /**
- * @brief Load the shaders, in order to display the result
+ * @brief Swaps in the programs linked since they were submitted, once per frame: until then,
+ * the previous programs are drawn with
  *
- * @param erase_if_program_registered Allow to erase the shader if it exists
- * @return true The shader has been successfully registered
- * @return false The shader has not been registered, due to an error
+ * @param wait Wait for the driver to link them, at startup
+ * @return false A program has never been linked, due to an error
  */
-const bool loadShaderProgram(const bool erase_if_program_registered);
+const bool pollShaderPrograms(const bool wait);
 
 /*
  * Callback to handle the "reload" event, once the user pressed the 'r' key.
@@ -63,17 +66,55 @@ static void reloadShaders(GLFWwindow *window, int key, int scancode, int action,
     if (key == GLFW_KEY_R && action == GLFW_PRESS)
     {
         debug("reloading...");
-        loadShaderProgram(true);
+        // Swapped in by the frame loop once linked, so that the reload never stalls a frame
+        shader_loader.overrideAll();
+        permutations.reload();
+    }
+}
+
+/*
+ * Callback to handle the "instanced" event, once the user pressed the 'i' key.
+ */
+static void toggleInstanced(GLFWwindow *window, int key, int scancode, int action, int _mods)
+{
+    if (key == GLFW_KEY_I && action == GLFW_PRESS)
+    {
+        instanced_mode = !instanced_mode;
+        debug("path drawn from " << (instanced_mode ? "instanced segments" : "its styled mesh"));
+    }
+}
+
+/*
+ * Callback to handle the "quantized" event, once the user pressed the 'q' key.
+ */
+static void toggleQuantized(GLFWwindow *window, int key, int scancode, int action, int _mods)
+{
+    if (key == GLFW_KEY_Q && action == GLFW_PRESS)
+    {
+        quantized_mode = !quantized_mode;
+        debug("path drawn from " << (quantized_mode ? "quantized chunks" : "full precision vertices"));
     }
 }
 
+/*
+ * GLFW keeps a single key callback: forwards the events to the ones above.
+ */
+static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+    quitCallback(window, key, scancode, action, mods);
+    reloadShaders(window, key, scancode, action, mods);
+    toggleInstanced(window, key, scancode, action, mods);
+    toggleQuantized(window, key, scancode, action, mods);
+}
+
 /*
  * Initializes the window and viewport via GLFW.
  * The viewport takes the all window.
  * If an error happens, the function returns `NULL` but **does not** free / terminate the GLFW library.
  * Then, do not forget to call `glfwTerminate` if this function returns `NULL`.
+ * A headless window has a context but no display, see GLUtils::createHeadlessWindow.
  */
-GLFWwindow *initializeWindow()
+GLFWwindow *initializeWindow(const bool headless)
 {
     // Minimum target is OpenGL 4.1
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -81,16 +122,14 @@ GLFWwindow *initializeWindow()
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint (GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 
-    GLFWwindow *window = glfwCreateWindow(HEIGHT, WIDTH, WINDOW_NAME, NULL, NULL);
+    GLFWwindow *window = headless ? GLUtils::createHeadlessWindow(HEIGHT, WIDTH, WINDOW_NAME) : glfwCreateWindow(HEIGHT, WIDTH, WINDOW_NAME, NULL, NULL);
     if (!window)
     {
         error("window creation failed");
         return NULL;
     }
-    // Close the window as soon as the Escape key has been pressed
-    glfwSetKeyCallback(window, quitCallback);
-    // Easy reload
-    glfwSetKeyCallback(window, reloadShaders);
+    // Escape to close the window, 'r' to reload the shaders, 'i' and 'q' to switch the path mode
+    glfwSetKeyCallback(window, keyCallback);
     // Makes the window context current
     glfwMakeContextCurrent(window);
     // Enable the viewport
@@ -99,65 +138,49 @@ GLFWwindow *initializeWindow()
     return window;
 }
 
-/**
- * @brief Returns the all file, as a string, which the file path has been passed
- * as parameter
- *
- * @param path The path of the file
- * @return The content of the file, as a string (read all file)
- */
-inline auto readFile(const std::string_view path) -> const std::string
+const bool pollShaderPrograms(const bool wait)
 {
-    // Avoid dynamic allocation: read the 4096 first bytes
-    constexpr auto read_size = std::size_t(4096);
-    auto stream = std::ifstream(path.data());
-    stream.exceptions(std::ios_base::badbit);
-
-    auto out = std::string();
-    auto buf = std::string(read_size, '\0');
-    while (stream.read(&buf[0], read_size))
+    if (permutations.poll(wait) == ShaderUtils::PROGRAM_READY)
     {
-        out.append(buf, 0, stream.gcount());
+        debug(permutations.size() << " programs, " << permutations.getStageCache().getCompileCount() << " stages compiled so far");
+        // The cache may still hold the programs they replaced
+        state_cache.invalidate();
+        program_linked = true;
     }
-    out.append(buf, 0, stream.gcount());
-    return out;
+    // A failed reload keeps the previous program
+    for (const ShaderUtils::Program *program : permutations.getPrograms())
+        if (!program->programIsRegistered())
+            return false;
+    return true;
 }
 
-const bool loadShaderProgram(const bool erase_if_program_registered = true)
+/**
+ * @brief Starts compiling the shaders of the frame, in order to display the result
+ */
+void createShaderPrograms(AttributeFrame &frame)
 {
-    const std::string basicVertexShaderSource = readFile("/Users/parksejin/Documents/opengl-explorer/attribute/shaders/vertex_shader.glsl");
-    const std::string basicFragmentShaderSource = readFile("/Users/parksejin/Documents/opengl-explorer/attribute/shaders/fragment_shader.glsl");
-
-    if (!shader_utils.registerShader(ShaderUtils::Type::VERTEX_SHADER_TYPE, basicVertexShaderSource.c_str()))
-    {
-        error("failed to register the vertex shader...");
-        return false;
-    }
-
-    if (!shader_utils.registerShader(ShaderUtils::Type::FRAGMENT_SHADER_TYPE, basicFragmentShaderSource.c_str()))
-    {
-        error("failed to register the fragment shader...");
-        return false;
-    }
-
-    if (!shader_utils.registerProgram(erase_if_program_registered))
-    {
-        error("failed to register the program...");
-        return false;
-    }
-    return true;
+    // The includes shared with the other demos, e.g. line_expand.glsl
+    shader_loader.addOverrideDirectory(HOME_PATH "/Base/shaders");
+    permutations.getPreprocessor().setLoader(shader_loader);
+    // Linked programs are reused across runs, until the sources or the driver change
+    permutations.setBinaryCache(SHADER_CACHE_PATH);
+    frame.createPrograms(permutations);
 }
 
-int main(void)
+int main(int argc, char **argv)
 {
+    // `--headless N` renders N frames offscreen, without a display, and reports the frame times
+    const size_t headless_frames = GLUtils::headlessFrames(argc, argv);
+    const bool headless = headless_frames > 0;
+
     // Initialize the lib
-    if (!glfwInit())
+    if (!(headless ? GLUtils::initHeadless() : glfwInit()))
     {
         error("could not start GLFW3");
         return -1;
     }
 
-    GLFWwindow *window = initializeWindow();
+    GLFWwindow *window = initializeWindow(headless);
     if (!window)
     {
         glfwTerminate();
@@ -170,8 +193,20 @@ int main(void)
     const GLubyte *version = glGetString(GL_VERSION);
     info("Renderer: " << renderer);
     info("OpenGL version supported: " << version);
-
-    if (!loadShaderProgram(false))
+    bool bufferStorage = GLUtils::loadExtensions(glfwGetProcAddress);
+    info("Persistent mapping: " << (bufferStorage ? "yes" : "no, buffers are orphaned"));
+    // The driver reports the errors of GL_CHECK when it can, otherwise one frame in 60 is checked
+    if (!GLUtils::enableDebugOutput(glfwGetProcAddress))
+        GLUtils::setCheckMode(GLUtils::CHECK_SAMPLED);
+    info("GL errors: " << (GLUtils::getCheckMode() == GLUtils::CHECK_DEBUG_OUTPUT ? "debug output" : "sampled"));
+
+    // The path, telemetry and field: the frames go through GLUtils::gl(), see the benchmark
+    AttributeFrame attribute_frame;
+
+    // The driver links the programs on its own threads, when it can
+    info("Parallel shader compilation: " << (ShaderUtils::enableParallelCompile(glfwGetProcAddress) ? "yes" : "no"));
+    createShaderPrograms(attribute_frame);
+    if (!pollShaderPrograms(true))
     {
         error("can't load the shaders to initiate the program");
         glfwTerminate();
@@ -179,213 +214,96 @@ int main(void)
     }
     /* END OF SHADER PART */
 
-    GLuint program = shader_utils.getProgram().value();
-
-    //default uniforms
-    GLint loc_model = glGetUniformLocation(program, "model");
-    GLint loc_projection = glGetUniformLocation(program, "projection");
-    GLint loc_view = glGetUniformLocation(program, "view");
-    GLint loc_thickness = glGetUniformLocation(program, "thickness");
-    GLint loc_aspect = glGetUniformLocation(program, "aspect");
-    GLint loc_miter = glGetUniformLocation(program, "miter");
-    // GLint loc_color = glGetUniformLocation(program, "color");
-
-    GL_TEST(glUseProgram(program));
-
-    float time = 0;
-    glm::mat4 projection = glm::mat4(1.0f);
-    glm::mat4 rotation = glm::mat4(1.0f);
-    glm::mat4 left = glm::mat4(1.0f);
-    glm::mat4 leftRotation = glm::mat4(1.0f);
-    glm::mat4 view = glm::mat4(1.0f);
-    glm::mat4 model = glm::mat4(1.0f);
-
-    view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
-    // left = glm::translate(left, glm::vec3(-0.25f, 0.25f, 0.0f));
-    // left = glm::scale(left, glm::vec3(0.5f, 0.5f, 0.5f));
-    // rotation = glm::scale(rotation, glm::vec3(0.75f, 0.75f, 0.75f));
-
-
-    // glUniformMatrix4fv(loc_model, 1, GL_FALSE, glm::value_ptr(model));
-    // glUniformMatrix4fv(loc_view, 1, GL_FALSE, glm::value_ptr(view));
-
-    GL_TEST(glUniform1f(loc_thickness, 0.3f));   
-    GL_TEST(glUniform1i(loc_miter, 1));  
-    // glUniform3fv(loc_color, glm::vec3(0.8f, 0.8f, 0.8f));
-
-    ////////////////////////////// path setting ////////////////////////////
-    std::vector<std::vector<float>> path;
-    path.push_back(std::vector<float> {0, -1, 0});
-    path.push_back({1, -1, 0});
-    path.push_back({0, 0, 0});
-    path.push_back({1, 0, 0});
-    path.push_back({0.25, -0.75, 0});
-
-    // path.push_back({-2, -1, 0});
-    // path.push_back({-2, 1, 0});
-    // path.push_back({-1, 1, 0});
-    // path.push_back({-1, -1, 0});
-    // path.push_back({0, -1, 0});
-    // path.push_back({0, 1, 0});
-    // path.push_back({1, 1, 0});
-    // path.push_back({1, -1, 0});
-    // path.push_back({2, -1, 0});
-    // path.push_back({2, 1, 0});
-
-    // std::cout << "path = " << std::endl;
-    // for (auto &el1 : path) {
-    //     for (auto &el2 : el1) {
-    //         std::cout << el2 << ", ";
-    //     }
-    //     std::cout << std::endl;
-    // }
-
-    int count = (path.size()-1) * 6;
-    // std::cout << std::endl;
-    // std::cout << "count = " << count << std::endl;
-
-    std::vector<float> direction(MathsUtils::duplicate(path, true));
-    // std::cout << std::endl;
-    // std::cout << "direction = " << std::endl;
-    // for (auto &el : direction) {
-    //     std::cout << el << ", ";
-    // }
-    // std::cout << std::endl;
-
-    std::vector<float> positions(MathsUtils::duplicate(path, false));
-    // std::cout << std::endl;
-    // std::cout << "positions = " << std::endl;
-    // for (auto &el : positions) {
-    //     std::cout << el << ", ";
-    // }
-    // std::cout << std::endl;
-
-    std::vector<float> previous(MathsUtils::duplicate(MathsUtils::relative(path, -1), false));
-    // std::cout << std::endl;
-    // std::cout << "previous = " << std::endl;
-    // for (auto &el : previous) {
-    //     std::cout << el << ", ";
-    // }
-    // std::cout << std::endl;
-
-    std::vector<float> next(MathsUtils::duplicate(MathsUtils::relative(path, +1), false));
-    // std::cout << std::endl;
-    // std::cout << "next = " << std::endl;
-    // for (auto &el : next) {
-    //     std::cout << el << ", ";
-    // }
-    // std::cout << std::endl;
-
-    std::vector<GLushort> indices(MathsUtils::createIndices(path.size()));
-    // std::cout << std::endl;
-    // std::cout << "indices = " << std::endl;
-    // for (auto &el : indices) {
-    //     std::cout << el << ", ";
-    // }
-    // std::cout << std::endl;    
-    //////////////////////////////////////////////////////////////////////////////////////////
-
-    GLuint VBO[4];
-    GLuint IBO = 0;
-    GLuint VAO = 0;
-
-    GL_TEST(glGenBuffers(4, VBO));
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, VBO[0]));
-    GL_TEST(glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(*positions.data()), positions.data(), GL_STATIC_DRAW));
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, 0));
-
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, VBO[1]));
-    GL_TEST(glBufferData(GL_ARRAY_BUFFER, direction.size() * sizeof(*direction.data()), direction.data(), GL_STATIC_DRAW));
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, 0));
-
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, VBO[2]));
-    GL_TEST(glBufferData(GL_ARRAY_BUFFER, next.size() * sizeof(*next.data()), next.data(), GL_STATIC_DRAW));
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, 0));    
-
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, VBO[3]));
-    GL_TEST(glBufferData(GL_ARRAY_BUFFER, previous.size() * sizeof(*previous.data()), previous.data(), GL_STATIC_DRAW));
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, 0));
-
-    GL_TEST(glGenBuffers(1, &IBO));
-    GL_TEST(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO));
-    GL_TEST(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(*indices.data()), indices.data(), GL_STATIC_DRAW));
-    GL_TEST(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));       
-
-    GL_TEST(glGenVertexArrays(1, &VAO));
-    GL_TEST(glBindVertexArray(VAO));     
-
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, VBO[0]));
-    GL_TEST(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0));
-    GL_TEST(glEnableVertexAttribArray(0));
-
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, VBO[1]));
-    GL_TEST(glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 1 * sizeof(float), (void*)0));
-    GL_TEST(glEnableVertexAttribArray(1));
-
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, VBO[2]));
-    GL_TEST(glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0));
-    GL_TEST(glEnableVertexAttribArray(2));
-
-    GL_TEST(glBindBuffer(GL_ARRAY_BUFFER, VBO[3]));
-    GL_TEST(glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0));
-    GL_TEST(glEnableVertexAttribArray(3));
-
-    GL_TEST(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO));
-    GL_TEST(glBindVertexArray(0));
-
-    GL_TEST(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
-
-    int vpSize[2]{0, 0};
+    // Saving a shader file, or a file it includes, reloads its programs from the saved files
+    std::optional<ShaderUtils::FileWatcher> shader_watcher;
+    if (!headless)
+    {
+        std::vector<std::string> paths;
+        for (const std::string &name : permutations.getFiles())
+            paths.push_back(shader_loader.getOverridePath(name));
+        shader_watcher.emplace(paths);
+    }
+
+    // The window of a headless context has no framebuffer to draw into
+    std::optional<GLUtils::OffscreenTarget> offscreen;
+    GLUtils::FrameTimes frame_times;
+    if (headless)
+    {
+        offscreen.emplace(HEIGHT, WIDTH);
+        if (!offscreen->isComplete())
+        {
+            error("the offscreen framebuffer is incomplete");
+            glfwTerminate();
+            return -1;
+        }
+        offscreen->bind();
+    }
 
     float now = 0, lastTime = 0;
     float timer = 0;
+    size_t frame = 0;
 
-    while (!glfwWindowShouldClose(window))
+    while (headless ? frame < headless_frames : !glfwWindowShouldClose(window))
     {
+        frame_times.begin();
         int w, h;
-        float aspect;
         glfwGetFramebufferSize(window, &w, &h);
-        // GL_TEST(glEnable(GL_DEPTH_TEST));
-        // GL_TEST(glDisable(GL_CULL_FACE));
 
         now = glfwGetTime();
         // std::cout << now << std::endl;
-        double delta = now - lastTime;
+        // Headless runs animate at a fixed step, so that they render the same frames
+        double delta = headless ? 1.0 / 60.0 : now - lastTime;
         lastTime = now;
         timer += delta;
 
-        if (w != vpSize[0] ||  h != vpSize[1])
+        if (shader_watcher)
         {
-            vpSize[0] = w; vpSize[1] = h;
-            GL_TEST(glViewport(0, 0, vpSize[0], vpSize[1]));
-            aspect = (float)w/(float)h;
-            GL_TEST(glUniform1f(loc_aspect, aspect));   
-            projection = glm::perspective((float)M_PI/4, aspect, 0.0f, 1000.0f);
-            std::cout << glm::to_string(projection) << std::endl;
-            std::cout << "vpSize[0] = " << vpSize[0] << ", vpSize[1] = " << vpSize[1] << ", aspect = " << aspect << std::endl;
-            GL_TEST(glUniformMatrix4fv(loc_projection, 1, GL_FALSE, glm::value_ptr(projection)));   
+            std::vector<std::string> changed;
+            for (const std::string &path : shader_watcher->takeChanges())
+            {
+                changed.push_back(shader_loader.getName(path));
+                shader_loader.override(changed.back());
+            }
+            if (!changed.empty())
+            {
+                debug("reloading " << changed.size() << " changed shaders...");
+                permutations.reload(changed);
+            }
+        }
+        if (pollShaderPrograms(false) && program_linked)
+        {
+            program_linked = false;
+            attribute_frame.setUniforms();
         }
 
-        GL_TEST(glClear(GL_COLOR_BUFFER_BIT));
-        GL_TEST(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
-
-        GL_TEST(glUseProgram(program));
-        leftRotation = leftRotation * left;
-        leftRotation = glm::rotate(glm::mat4(1.0f), glm::radians(timer * 10.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        // leftRotation = glm::rotate(glm::mat4(1.0f), glm::radians(85.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        // std::cout << glm::to_string(leftRotation) << std::endl;
-        GL_TEST(glUniformMatrix4fv(loc_model, 1, GL_FALSE, glm::value_ptr(leftRotation)));   
-        GL_TEST(glUniformMatrix4fv(loc_view, 1, GL_FALSE, glm::value_ptr(view)));   
+        attribute_frame.draw(state_cache, w, h, timer, instanced_mode, quantized_mode);
 
-        GL_TEST(glBindVertexArray(VAO));
-        GL_TEST(glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, nullptr));
-        GL_TEST(glBindVertexArray(0));
-        GL_TEST(glUseProgram(0));
+        // The program and vertex arrays stay bound: the next frame only sends what changed
+        StateUtils::StateCounters counters = state_cache.endFrame();
+        GLUtils::endCheckFrame();
+        if (frame++ % 300 == 0)
+            debug("state calls: " << counters.issued << " issued, " << counters.elided << " elided, "
+                                  << attribute_frame.getUploadWaits() << " upload waits, " << GLUtils::getErrorCount() << " GL errors");
 
-        glfwSwapBuffers(window);
+        if (headless)
+        {
+            // The frame time includes the rendering
+            GL_CHECK(glFinish());
+            frame_times.end();
+        }
+        else
+        {
+            glfwSwapBuffers(window);
+        }
         glfwPollEvents();
     }
 
+    if (headless)
+    {
+        frame_times.report("attribute");
+        info("last frame checksum: " << std::hex << offscreen->checksum() << std::dec);
+    }
+    offscreen.reset();
     glfwTerminate();
     return 0;
 }
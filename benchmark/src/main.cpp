@@ -0,0 +1,372 @@
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include "../../glm/glm/glm.hpp"
+#include "../../glm/glm/gtc/matrix_transform.hpp"
+#include <Base/logs.h>
+#include <Base/maths_utils.h>
+#include <Base/line_utils.h>
+#include <Base/line_extrude.h>
+#include <Base/line_batch.h>
+#include <Base/thread_pool.h>
+#include <Base/line_lod.h>
+#include <Base/line_pool.h>
+#include <Base/line_quantize.h>
+#include <Base/state_cache.h>
+#include <Base/shader_utils.h>
+#include <Base/shader_loader.h>
+#include <Base/shader_preprocessor.h>
+#include <Base/gl_dispatch.h>
+#include <Base/gl_check.h>
+#include "attribute_frame.h"
+#include "uniformblock_frame.h"
+#include <iostream>
+
+/**
+ * @brief Runs `function` `iterations` times and returns the best wall time, in seconds
+ */
+template <typename Function>
+double bestOf(const int iterations, Function function)
+{
+    double best = 1e30;
+    for (int i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/*
+ * Reports the throughput of a preprocessing step, in millions of input points per second.
+ */
+static void report(const char *name, const size_t points, const double seconds)
+{
+    info(name << ": " << seconds * 1000.0 << " ms, " << points / seconds / 1e6 << " Mpoints/s");
+}
+
+/*
+ * Reports the GL traffic recorded over `frames` frames, and clears the recorder.
+ */
+static void reportFrames(const char *name, GLUtils::Recorder &recorder, const size_t frames, const StateUtils::StateCounters &state)
+{
+    info(name << ": " << recorder.totalCalls() / (double)frames << " calls/frame, "
+              << state.elided / (double)frames << " elided/frame, "
+              << recorder.uploadedBytes / (double)frames << " bytes uploaded/frame, "
+              << recorder.stream.size() / (double)frames << " bytes of commands/frame");
+    for (int call = 0; call < GLUtils::CALL_COUNT; call++)
+        if (recorder.calls[call] > 0)
+            info("    " << GLUtils::callName((GLUtils::Call)call) << ": " << recorder.calls[call] / (double)frames);
+    recorder.clear();
+}
+
+/*
+ * Links the programs submitted to a cache, with the recorder: false if one has no program,
+ * e.g. a shader is missing.
+ */
+static bool linkPrograms(ShaderUtils::PermutationCache &permutations)
+{
+    permutations.poll(true);
+    for (const ShaderUtils::Program *program : permutations.getPrograms())
+        if (!program->programIsRegistered())
+            return false;
+    return true;
+}
+
+/*
+ * Records the frames of both demos with the recording GL backend, no context needed: the
+ * uniformblock frame (paged polylines, per-draw uniforms), then the attribute frame drawing
+ * the path in each of its modes (culled styled mesh, instanced segments, quantized chunks).
+ * Their programs are compiled from the shaders of the source tree, GL_CHECK is off as in a
+ * release build.
+ */
+static bool recordDemoFrames(const size_t frames)
+{
+    GLUtils::Recorder recorder;
+    GLUtils::record(recorder);
+    const GLUtils::CheckMode checkMode = GLUtils::getCheckMode();
+    GLUtils::setCheckMode(GLUtils::CHECK_OFF);
+    bool linked = true;
+    {
+        ShaderUtils::ShaderLoader shaders(nullptr, 0, HOME_PATH "/uniformblock/shaders");
+        shaders.addOverrideDirectory(HOME_PATH "/Base/shaders");
+        shaders.overrideAll();
+        ShaderUtils::PermutationCache permutations;
+        permutations.getPreprocessor().setLoader(shaders);
+        UniformBlockFrame uniformblock;
+        uniformblock.createProgram(permutations);
+        linked = linkPrograms(permutations);
+        if (linked)
+        {
+            uniformblock.setUniforms();
+            recorder.clear();
+            StateUtils::StateCache state;
+            for (size_t frame = 0; frame < frames; frame++)
+                uniformblock.draw(state, 1920, 1080);
+            reportFrames("uniformblock frame", recorder, frames, state.endFrame());
+        }
+    }
+    {
+        ShaderUtils::ShaderLoader shaders(nullptr, 0, HOME_PATH "/attribute/shaders");
+        shaders.addOverrideDirectory(HOME_PATH "/Base/shaders");
+        shaders.overrideAll();
+        ShaderUtils::PermutationCache permutations;
+        permutations.getPreprocessor().setLoader(shaders);
+        const char *modes[3] = {"attribute frame", "attribute frame, instanced", "attribute frame, quantized"};
+        for (int mode = 0; mode < 3 && linked; mode++)
+        {
+            // From the first frame: the telemetry streams one point per frame
+            AttributeFrame attribute;
+            attribute.createPrograms(permutations);
+            linked = linkPrograms(permutations);
+            if (!linked)
+                break;
+            attribute.setUniforms();
+            recorder.clear();
+            StateUtils::StateCache state;
+            for (size_t frame = 0; frame < frames; frame++)
+                attribute.draw(state, 1920, 1080, frame / 60.0f, mode == 1, mode == 2);
+            reportFrames(modes[mode], recorder, frames, state.endFrame());
+        }
+    }
+    GLUtils::setCheckMode(checkMode);
+    GLUtils::setDispatch(GLUtils::nativeDispatch());
+    return linked;
+}
+
+/*
+ * Records the submission of many small polylines: one VAO and one draw per line, then all
+ * of them suballocated in a LinePool and drawn with a single glMultiDrawElementsBaseVertex.
+ */
+static void recordPoolFrames(const size_t lines, const size_t frames)
+{
+    GLUtils::Recorder recorder;
+    GLUtils::record(recorder);
+    const GLUtils::Dispatch &gl = GLUtils::gl();
+    StateUtils::StateCache state;
+
+    std::vector<std::vector<glm::vec3>> polylines(lines);
+    for (size_t line = 0; line < lines; line++)
+        for (size_t i = 0; i < 32; i++)
+            polylines[line].push_back(glm::vec3(0.1f * i, 0.1f * std::sin(0.3f * i + line), 0.01f * line));
+
+    std::vector<GLuint> arrays(lines);
+    gl.GenVertexArrays((GLsizei)lines, arrays.data());
+    recorder.clear();
+    for (size_t frame = 0; frame < frames; frame++)
+        for (size_t line = 0; line < lines; line++)
+        {
+            state.bindVertexArray(arrays[line]);
+            gl.DrawElements(GL_TRIANGLES, (GLsizei)(polylines[line].size() - 1) * 6, GL_UNSIGNED_INT, nullptr);
+        }
+    reportFrames("one VAO per line", recorder, frames, state.endFrame());
+
+    LineUtils::LinePool pool;
+    for (const std::vector<glm::vec3> &polyline : polylines)
+        pool.addPolyline(polyline.data(), polyline.size());
+    pool.upload();
+    GLuint poolArray;
+    gl.GenVertexArrays(1, &poolArray);
+    LineUtils::PoolDrawList draws;
+    state.invalidate();
+    recorder.clear();
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        state.bindVertexArray(poolArray);
+        pool.drawAll(draws);
+        gl.MultiDrawElementsBaseVertex(GL_TRIANGLES, draws.counts.data(), GL_UNSIGNED_INT, draws.offsets.data(), draws.size(), draws.baseVertices.data());
+    }
+    reportFrames("LinePool", recorder, frames, state.endFrame());
+    GLUtils::setDispatch(GLUtils::nativeDispatch());
+}
+
+/*
+ * Compares the legacy duplicate / relative chain against the single-pass LineUtils::expand,
+ * then the SIMD LineUtils::extrude against its scalar reference, then LineUtils::tessellateBatch
+ * with an increasing number of threads, the LOD levels picked for a zoomed-out view, and finally
+ * the GL calls and bytes of the demo frames, recorded without a context.
+ * Usage: benchmark [points] [iterations]
+ */
+int main(int argc, char **argv)
+{
+    const size_t nbPoints = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+    // The batch checks read the last polyline: there must be one
+    if (nbPoints == 0)
+    {
+        error("the number of points must be positive");
+        return -1;
+    }
+
+    std::vector<glm::vec3> points(nbPoints);
+    std::vector<std::vector<float>> path(nbPoints);
+    for (size_t i = 0; i < nbPoints; i++)
+    {
+        float t = (float)i * 0.01f;
+        points[i] = glm::vec3(t, std::sin(t), 0.0f);
+        path[i] = {points[i].x, points[i].y, points[i].z};
+    }
+    info("points: " << nbPoints << ", iterations: " << iterations);
+
+    std::vector<float> direction, positions, previous, next;
+    double legacy = bestOf(iterations, [&]()
+                           {
+        direction = MathsUtils::duplicate(path, true);
+        positions = MathsUtils::duplicate(path, false);
+        previous = MathsUtils::duplicate(MathsUtils::relative(path, -1), false);
+        next = MathsUtils::duplicate(MathsUtils::relative(path, +1), false); });
+    report("duplicate/relative", nbPoints, legacy);
+
+    std::vector<LineUtils::LineVertex> vertices(LineUtils::expandedSize(nbPoints));
+    double expand = bestOf(iterations, [&]()
+                           { LineUtils::expand(points.data(), points.size(), vertices.data()); });
+    report("LineUtils::expand", nbPoints, expand);
+    info("speedup: " << legacy / expand << "x");
+
+    // Both paths must produce the same attributes
+    for (size_t v = 0; v < vertices.size(); v++)
+    {
+        const LineUtils::LineVertex &vertex = vertices[v];
+        for (int c = 0; c < 3; c++)
+        {
+            if (vertex.position[c] != positions[v * 3 + c] || vertex.next[c] != next[v * 3 + c] || vertex.previous[c] != previous[v * 3 + c])
+            {
+                error("mismatch at vertex " << v);
+                return -1;
+            }
+        }
+        if (vertex.direction != direction[v])
+        {
+            error("direction mismatch at vertex " << v);
+            return -1;
+        }
+    }
+
+    // Same setup as the attribute demo
+    LineUtils::ExtrudeParams params;
+    params.aspect = 16.0f / 9.0f;
+    params.thickness = 0.3f;
+    glm::mat4 projection = glm::perspective((float)M_PI / 4, params.aspect, 0.1f, 1000.0f);
+    glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+    glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    params.projViewModel = projection * view * model;
+
+    std::vector<glm::vec4> reference(vertices.size()), extruded(vertices.size());
+    double scalar = bestOf(iterations, [&]()
+                           { LineUtils::extrudeReference(vertices.data(), vertices.size(), params, reference.data()); });
+    report("LineUtils::extrudeReference", vertices.size(), scalar);
+    double simd = bestOf(iterations, [&]()
+                         { LineUtils::extrude(vertices.data(), vertices.size(), params, extruded.data()); });
+    report(LineUtils::extrudeArch(), vertices.size(), simd);
+    info("speedup: " << scalar / simd << "x");
+
+    float maxError = 0.0f;
+    for (size_t v = 0; v < vertices.size(); v++)
+    {
+        glm::vec4 difference = glm::abs(reference[v] - extruded[v]);
+        maxError = std::max(maxError, std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w)));
+    }
+    info("max error: " << maxError << " (tolerance " << LineUtils::EXTRUDE_TOLERANCE << ")");
+    if (!(maxError <= LineUtils::EXTRUDE_TOLERANCE))
+    {
+        error("extrude exceeds its tolerance");
+        return -1;
+    }
+
+    // The same points, cut into many independent polylines
+    const size_t nbPolylines = std::max<size_t>(nbPoints / 200, 1);
+    std::vector<LineUtils::PolylineView> polylines;
+    for (size_t first = 0; first < nbPoints; first += nbPoints / nbPolylines)
+        polylines.push_back({&points[first], std::min(nbPoints / nbPolylines, nbPoints - first)});
+    info("polylines: " << polylines.size());
+
+    LineUtils::Batch batch;
+    double single = 0.0;
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2)
+    {
+        ThreadUtils::ThreadPool pool(threads);
+        double seconds = bestOf(iterations, [&]()
+                                { LineUtils::tessellateBatch(polylines.data(), polylines.size(), pool, batch); });
+        if (threads == 1)
+            single = seconds;
+        report(("tessellateBatch, " + std::to_string(threads) + " threads").c_str(), nbPoints, seconds);
+        info("scaling: " << single / seconds << "x");
+    }
+
+    const LineUtils::BatchRange &last = batch.ranges.back();
+    std::vector<LineUtils::LineVertex> expected(last.vertexCount);
+    LineUtils::expand(polylines.back().points, polylines.back().count, expected.data());
+    for (size_t v = 0; v < expected.size(); v++)
+    {
+        const LineUtils::LineVertex &vertex = batch.vertices[last.firstVertex + v];
+        if (vertex.position != expected[v].position || vertex.next != expected[v].next || vertex.previous != expected[v].previous)
+        {
+            error("batch mismatch at vertex " << v);
+            return -1;
+        }
+        // The chunks sum their arc lengths in another order
+        if (std::fabs(vertex.distance - expected[v].distance) > 1e-5f * expected[v].distance + 1e-6f)
+        {
+            error("batch distance mismatch at vertex " << v);
+            return -1;
+        }
+    }
+    if (last.indexCount > 0 && batch.indices[last.firstIndex + last.indexCount - 1] != last.firstVertex + last.vertexCount - 1)
+    {
+        error("batch indices do not match the vertices");
+        return -1;
+    }
+
+    // A noisy signal fitting the view of the attribute demo
+    std::vector<glm::vec3> signal(nbPoints);
+    for (size_t i = 0; i < nbPoints; i++)
+    {
+        float x = -1.0f + 2.0f * i / nbPoints;
+        signal[i] = glm::vec3(x, 0.5f * std::sin(20.0f * x) + 0.01f * std::sin(7919.0f * x), 0.0f);
+    }
+    LineUtils::LodHierarchy lod;
+    double build = bestOf(1, [&]()
+                          { lod.build(signal.data(), signal.size()); });
+    report("LodHierarchy::build", nbPoints, build);
+    for (size_t level = 0; level < lod.getLevelCount(); level++)
+        info("level " << level << ": " << lod.getLevel(level).points.size() << " points, error " << lod.getLevel(level).error);
+    for (float distance : {3.0f, 30.0f, 300.0f, 3000.0f})
+    {
+        glm::mat4 zoomedOut = projection * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -distance));
+        size_t level = lod.selectLevel(zoomedOut, glm::vec2(1920.0f, 1080.0f), 0.5f);
+        info("camera at " << distance << ": level " << level << ", " << lod.getLevel(level).points.size() << " points");
+    }
+
+    // The bytes fetched per point, and the precision lost by the compact formats
+    const size_t signalBytes = LineUtils::expandedSize(nbPoints) * sizeof(LineUtils::LineVertex);
+    info("signal: " << signalBytes << " bytes expanded, " << LineUtils::aliasedSize(nbPoints) * sizeof(LineUtils::AliasedLineVertex) << " bytes aliased");
+    for (LineUtils::QuantizedFormat format : {LineUtils::SNORM16_FORMAT, LineUtils::HALF_FORMAT})
+    {
+        LineUtils::QuantizedLine quantized;
+        double seconds = bestOf(iterations, [&]()
+                                { LineUtils::quantize(signal.data(), signal.size(), format, LineUtils::LINE_CHUNK_SEGMENTS, quantized); });
+        report(format == LineUtils::HALF_FORMAT ? "quantize, half" : "quantize, snorm16", nbPoints, seconds);
+        float positionError = 0.0f;
+        float distanceError = 0.0f;
+        for (const LineUtils::QuantizedChunk &chunk : quantized.chunks)
+        {
+            positionError = std::max(positionError, chunk.positionError);
+            distanceError = std::max(distanceError, chunk.distanceError);
+        }
+        info(quantized.vertices.size() * sizeof(LineUtils::CompactLineVertex) << " bytes in " << quantized.chunks.size() << " chunks, error "
+                                                                              << positionError << " (position) " << distanceError << " (distance)");
+    }
+
+    if (!recordDemoFrames(600))
+    {
+        error("the shaders of the demos can't be loaded");
+        return -1;
+    }
+    recordPoolFrames(4096, 60);
+    return 0;
+}
@@ -1,8 +1,21 @@
 #version 330 core
 
+in float v_distance;
+
+#ifdef LINE_DASH
+// 16-bit stipple pattern, each bit covering `u_factor` units of arc length
+uniform int   u_pattern;
+uniform float u_factor;
+#endif
+
 out vec4 fragColor;
 
 void main()
 {
+#ifdef LINE_DASH
+    int bit = int(mod(v_distance / u_factor, 16.0));
+    if ((u_pattern & (1 << bit)) == 0)
+        discard;
+#endif
     fragColor = vec4(1.0);
 }
\ No newline at end of file
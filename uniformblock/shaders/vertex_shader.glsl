@@ -5,16 +5,23 @@
 //    vec4 vertex[]; 
 // };
 
+// One page of LineUtils::LinePages, LINE_PAGE_VERTICES points, w is the arc length
 layout (std140) uniform BlockRect
 {
-    vec4 vertex[100];
+    vec4 vertex[1024];
 } u_Rect;
 
 
+uniform int   u_offset;
 uniform mat4  u_mvp;
 uniform vec2  u_resolution;
 uniform float u_thickness;
 
+out float v_distance;
+
+// joinNormal, see ShaderUtils::Preprocessor
+#include "line_expand.glsl"
+
 void main()
 {
     int line_i = gl_VertexID / 6;
@@ -23,30 +30,24 @@ void main()
     vec4 va[4];
     for (int i=0; i<4; ++i)
     {
-        va[i] = u_mvp * u_Rect.vertex[line_i+i];
+        va[i] = u_mvp * vec4(u_Rect.vertex[u_offset+line_i+i].xyz, 1.0);
         va[i].xyz /= va[i].w;
         va[i].xy = (va[i].xy + 1.0) * 0.5 * u_resolution;
     }
 
-    vec2 v_line  = normalize(va[2].xy - va[1].xy);
-    vec2 nv_line = vec2(-v_line.y, v_line.x);
-
+    // The joins of the segment, in pixels, with the point before it and the one after it
     vec4 pos;
     if (tri_i == 0 || tri_i == 1 || tri_i == 3)
     {
-        vec2 v_pred  = normalize(va[1].xy - va[0].xy);
-        vec2 v_miter = normalize(nv_line + vec2(-v_pred.y, v_pred.x));
-
         pos = va[1];
-        pos.xy += v_miter * u_thickness * (tri_i == 1 ? -0.5 : 0.5) / dot(v_miter, nv_line);
+        v_distance = u_Rect.vertex[u_offset+line_i+1].w;
+        pos.xy += joinNormal(va[0].xy, va[1].xy, va[2].xy) * u_thickness * (tri_i == 1 ? -0.5 : 0.5);
     }
     else
     {
-        vec2 v_succ  = normalize(va[3].xy - va[2].xy);
-        vec2 v_miter = normalize(nv_line + vec2(-v_succ.y, v_succ.x));
-
         pos = va[2];
-        pos.xy += v_miter * u_thickness * (tri_i == 5 ? 0.5 : -0.5) / dot(v_miter, nv_line);
+        v_distance = u_Rect.vertex[u_offset+line_i+2].w;
+        pos.xy += joinNormal(va[1].xy, va[2].xy, va[3].xy) * u_thickness * (tri_i == 5 ? 0.5 : -0.5);
     }
 
     pos.xy = pos.xy / u_resolution * 2.0 - 1.0;
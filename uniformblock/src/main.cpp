@@ -10,15 +10,17 @@
 
 #include <vector>
 #include <string>
-#include "../../glm/glm/glm.hpp"
-#include "../../glm/glm/gtc/matrix_transform.hpp"
-#include "../../glm/glm/gtc/type_ptr.hpp"
-#include "../../glm/glm/gtx/string_cast.hpp"
 #include <Base/logs.h>
 #include <Base/shader_utils.h>
-#include <Base/maths_utils.h>
+#include <Base/file_watcher.h>
+#include <Base/shader_loader.h>
+#include <Base/shader_preprocessor.h>
+#include <Base/state_cache.h>
+#include <Base/headless.h>
+#include "uniformblock_frame.h"
+#include "embedded_shaders.h"
 #include <iostream>
-#include <fstream>
+#include <optional>
 
 // GLuint CreateSSBO(std::vector<glm::vec4> &varray)
 // {
@@ -32,7 +34,13 @@
 const size_t WIDTH = 1080;
 const size_t HEIGHT = 1920;
 const char *WINDOW_NAME = "OpenGL";
-auto shader_utils = ShaderUtils::Program{};
+// The shaders embedded at build time, overridden by their files in the source tree once saved
+auto shader_loader = ShaderUtils::ShaderLoader(EmbeddedShaders::FILES, HOME_PATH "/uniformblock/shaders");
+// The program of the frame, a permutation of the shaders with their features compiled in
+auto permutations = ShaderUtils::PermutationCache{};
+auto state_cache = StateUtils::StateCache{};
+// Set when a program is linked, whose uniforms must be set again
+bool program_linked = true;
 
 /*
  * Callback to handle the "close window" event, once the user pressed the Escape key.
@@ -44,13 +52,19 @@ static void quitCallback(GLFWwindow *window, int key, int scancode, int action,
 }
 
 /**
- * @brief Load the shaders, in order to display the result
+ * @brief Starts compiling the shaders of the frame, in order to display the result
+ */
+void createShaderProgram(UniformBlockFrame &frame);
+
+/**
+ * @brief Swaps in the program linked since it was submitted, once per frame: until then,
+ * e.g. during a reload, the previous program is drawn with
  *
- * @param erase_if_program_registered Allow to erase the shader if it exists
- * @return true The shader has been successfully registered
- * @return false The shader has not been registered, due to an error
+ * @param frame The frame drawn with the program
+ * @param wait Wait for the driver to link it, at startup
+ * @return false No program has been linked, due to an error
  */
-const bool loadShaderProgram(const bool erase_if_program_registered);
+const bool pollShaderProgram(const UniformBlockFrame &frame, const bool wait);
 
 /*
  * Callback to handle the "reload" event, once the user pressed the 'r' key.
@@ -60,7 +74,9 @@ static void reloadShaders(GLFWwindow *window, int key, int scancode, int action,
     if (key == GLFW_KEY_R && action == GLFW_PRESS)
     {
         debug("reloading...");
-        loadShaderProgram(true);
+        // Swapped in by the frame loop once linked, so that the reload never stalls a frame
+        shader_loader.overrideAll();
+        permutations.reload();
     }
 }
 
@@ -69,15 +85,16 @@ static void reloadShaders(GLFWwindow *window, int key, int scancode, int action,
  * The viewport takes the all window.
  * If an error happens, the function returns `NULL` but **does not** free / terminate the GLFW library.
  * Then, do not forget to call `glfwTerminate` if this function returns `NULL`.
+ * A headless window has a context but no display, see GLUtils::createHeadlessWindow.
  */
-GLFWwindow *initializeWindow()
+GLFWwindow *initializeWindow(const bool headless)
 {
     // Minimum target is OpenGL 4.1
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    GLFWwindow *window = glfwCreateWindow(HEIGHT, WIDTH, WINDOW_NAME, NULL, NULL);
+    GLFWwindow *window = headless ? GLUtils::createHeadlessWindow(HEIGHT, WIDTH, WINDOW_NAME) : glfwCreateWindow(HEIGHT, WIDTH, WINDOW_NAME, NULL, NULL);
     if (!window)
     {
         error("window creation failed");
@@ -96,64 +113,47 @@ GLFWwindow *initializeWindow()
 }
 
 /**
- * @brief Returns the all file, as a string, which the file path has been passed
- * as parameter
- *
- * @param path The path of the file
- * @return The content of the file, as a string (read all file)
+ * The joins are mitered and the lines dashed: both are compiled in, not branched on.
  */
-inline auto readFile(const std::string_view path) -> const std::string
+void createShaderProgram(UniformBlockFrame &frame)
 {
-    // Avoid dynamic allocation: read the 4096 first bytes
-    constexpr auto read_size = std::size_t(4096);
-    auto stream = std::ifstream(path.data());
-    stream.exceptions(std::ios_base::badbit);
-
-    auto out = std::string();
-    auto buf = std::string(read_size, '\0');
-    while (stream.read(&buf[0], read_size))
-    {
-        out.append(buf, 0, stream.gcount());
-    }
-    out.append(buf, 0, stream.gcount());
-    return out;
+    // The includes shared with the other demos, e.g. line_expand.glsl
+    shader_loader.addOverrideDirectory(HOME_PATH "/Base/shaders");
+    permutations.getPreprocessor().setLoader(shader_loader);
+    // Linked programs are reused across runs, until the sources or the driver change
+    permutations.setBinaryCache(SHADER_CACHE_PATH);
+    frame.createProgram(permutations);
 }
 
-const bool loadShaderProgram(const bool erase_if_program_registered = true)
+const bool pollShaderProgram(const UniformBlockFrame &frame, const bool wait)
 {
-    const std::string basicVertexShaderSource = readFile("/Users/parksejin/Documents/opengl-explorer/uniformblock/shaders/vertex_shader.glsl");
-    const std::string basicFragmentShaderSource = readFile("/Users/parksejin/Documents/opengl-explorer/uniformblock/shaders/fragment_shader.glsl");
-
-    if (!shader_utils.registerShader(ShaderUtils::Type::VERTEX_SHADER_TYPE, basicVertexShaderSource.c_str()))
+    if (permutations.poll(wait) == ShaderUtils::PROGRAM_READY)
     {
-        error("failed to register the vertex shader...");
-        return false;
+        if (frame.getProgram().isFromBinaryCache())
+            debug("program loaded from the binary cache");
+        // The cache may still hold the program it replaced
+        state_cache.invalidate();
+        program_linked = true;
     }
-
-    if (!shader_utils.registerShader(ShaderUtils::Type::FRAGMENT_SHADER_TYPE, basicFragmentShaderSource.c_str()))
-    {
-        error("failed to register the fragment shader...");
-        return false;
-    }
-
-    if (!shader_utils.registerProgram(erase_if_program_registered))
-    {
-        error("failed to register the program...");
-        return false;
-    }
-    return true;
+    // Idle too when nothing was submitted, e.g. a shader failed to load: a failed reload
+    // keeps the previous program
+    return frame.getProgram().programIsRegistered();
 }
 
-int main(void)
+int main(int argc, char **argv)
 {
+    // `--headless N` renders N frames offscreen, without a display, and reports the frame times
+    const size_t headless_frames = GLUtils::headlessFrames(argc, argv);
+    const bool headless = headless_frames > 0;
+
     // Initialize the lib
-    if (!glfwInit())
+    if (!(headless ? GLUtils::initHeadless() : glfwInit()))
     {
         error("could not start GLFW3");
         return -1;
     }
 
-    GLFWwindow *window = initializeWindow();
+    GLFWwindow *window = initializeWindow(headless);
     if (!window)
     {
         glfwTerminate();
@@ -167,7 +167,13 @@ int main(void)
     info("Renderer: " << renderer);
     info("OpenGL version supported: " << version);
 
-    if (!loadShaderProgram(false))
+    // The polylines and their draws: the frames go through GLUtils::gl(), see the benchmark
+    UniformBlockFrame uniformblock_frame;
+
+    // The driver links the program on its own threads, when it can
+    info("Parallel shader compilation: " << (ShaderUtils::enableParallelCompile(glfwGetProcAddress) ? "yes" : "no"));
+    createShaderProgram(uniformblock_frame);
+    if (!pollShaderProgram(uniformblock_frame, true))
     {
         error("can't load the shaders to initiate the program");
         glfwTerminate();
@@ -175,218 +181,82 @@ int main(void)
     }
     /* END OF SHADER PART */
 
-    GLuint program = shader_utils.getProgram().value();
-
-    GLint  loc_mvp  = glGetUniformLocation(program, "u_mvp");
-    GLint  loc_res  = glGetUniformLocation(program, "u_resolution");
-    GLint  loc_thi  = glGetUniformLocation(program, "u_thickness");
-
-    glUseProgram(program);
-
-    glUniform1f(loc_thi, 20.0);
-
-    // GLushort pattern = 0x18ff;
-    // GLfloat  factor  = 2.0f;
-
-    glm::vec4 p00(-1.0f, -0.5f, 0.0f, 1.0f);
-    glm::vec4 p01(-0.5f,  0.5f, 0.0f, 1.0f);
-    glm::vec4 p02( 0.0f, -0.5f, 0.0f, 1.0f);
-    glm::vec4 p03( 0.5f,  0.5f, 0.0f, 1.0f);
-    glm::vec4 p04( 1.0f, -0.5f, 0.0f, 1.0f);
-    glm::vec4 p05( 1.5f,  0.5f, 0.0f, 1.0f);
-    glm::vec4 p06( 2.0f, -0.5f, 0.0f, 1.0f);
-    glm::vec4 p07( 2.5f,  0.5f, 0.0f, 1.0f);
-
-    std::vector<glm::vec4> varray0{p00, p01, p02, p03, p04, p05, p06, p07};
-
-    glm::vec4 p0(-1.0f, -1.0f, 0.0f, 1.0f);
-    glm::vec4 p1(1.0f, -1.0f, 0.0f, 1.0f);
-    glm::vec4 p2(1.0f, 1.0f, 0.0f, 1.0f);
-    glm::vec4 p3(-1.0f, 1.0f, 0.0f, 1.0f);
-    std::vector<glm::vec4> varray1{ p3, p0, p1, p2, p3, p0, p1 };
-    // GLuint ssbo1 = CreateSSBO(varray1);
-    // std::cout << "varray1" << std::endl;
-    // for (auto &el : varray1) {
-    //     std::cout << el[0] << ", " << el[1] << ", " << el[2] << ", " << el[3] << std::endl;
-    // }
-
-    std::vector<glm::vec4> varray2;
-    for (int u=-8; u <= 368; u += 8)
+    // Saving a shader file reloads the program from the saved file
+    std::optional<ShaderUtils::FileWatcher> shader_watcher;
+    if (!headless)
     {
-        double a = u*M_PI/180.0;
-        double c = cos(a), s = sin(a);
-        varray2.emplace_back(glm::vec4((float)c, (float)s, 0.0f, 1.0f));
-        std::cout << "u = " << u << ", a = " << a << " (" << c << ", " << s << ")" << std::endl;
+        std::vector<std::string> paths;
+        for (const std::string &name : permutations.getFiles())
+            paths.push_back(shader_loader.getOverridePath(name));
+        shader_watcher.emplace(paths);
     }
 
-    //std::cout << "varray2" << std::endl;
-    //for (auto &el : varray2) {
-    //    std::cout << el[0] << ", " << el[1] << ", " << el[2] << ", " << el[3] << std::endl;
-    //}
-
-    // GLuint ssbo2 = CreateSSBO(varray2);
-
-    GLuint ubo0 = 0;
-    glGenBuffers(1, &ubo0);
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo0);
-    glBufferData(GL_UNIFORM_BUFFER, varray0.size() * sizeof(*varray0.data()), varray0.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-    unsigned int block = glGetUniformBlockIndex(program, "BlockRect");
-    GLuint bind0 = 0;
-    glUniformBlockBinding(program, block, bind0);
-    glBindBufferRange(GL_UNIFORM_BUFFER, 0, ubo0, 0, sizeof(varray0));
-
-    GLuint ubo1 = 0;
-    glGenBuffers(1, &ubo1);
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo1);
-    glBufferData(GL_UNIFORM_BUFFER, varray1.size() * sizeof(*varray1.data()), varray1.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-    GLuint bind = 1;
-    glUniformBlockBinding(program, block, bind);
-    glBindBufferRange(GL_UNIFORM_BUFFER, 1, ubo1, 0, sizeof(varray1));
-
-    GLuint ubo2 = 0;
-    glGenBuffers(1, &ubo2);
-    glBindBuffer(GL_UNIFORM_BUFFER, ubo2);
-    glBufferData(GL_UNIFORM_BUFFER, varray2.size() * sizeof(*varray2.data()), varray2.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-    GLuint bind2 = 2;
-    glUniformBlockBinding(program, block, bind2);
-    glBindBufferRange(GL_UNIFORM_BUFFER, 2, ubo2, 0, sizeof(varray2));
-
-    GLuint vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-    glm::mat4(project);
-    int vpSize[2]{0, 0};
-
-    while (!glfwWindowShouldClose(window))
+    // The window of a headless context has no framebuffer to draw into
+    std::optional<GLUtils::OffscreenTarget> offscreen;
+    GLUtils::FrameTimes frame_times;
+    if (headless)
     {
-        int w, h;
-        glfwGetFramebufferSize(window, &w, &h);
-        if (w != vpSize[0] ||  h != vpSize[1])
+        offscreen.emplace(HEIGHT, WIDTH);
+        if (!offscreen->isComplete())
         {
-            vpSize[0] = w; vpSize[1] = h;
-            glViewport(0, 0, vpSize[0], vpSize[1]);
-            float aspect = (float)w/(float)h;
-            project = glm::ortho(-aspect, aspect, -1.0f, 1.0f, -10.0f, 10.0f);
-            glUniform2f(loc_res, (float)w, (float)h);
+            error("the offscreen framebuffer is incomplete");
+            glfwTerminate();
+            return -1;
         }
+        offscreen->bind();
+    }
 
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // line1 
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glm::mat4 modelview1( 1.0f );
-        modelview1 = glm::translate(modelview1, glm::vec3(-1.0f, 0.6f, 0.0f) );
-        modelview1 = glm::scale(modelview1, glm::vec3(0.2f, 0.2f, 1.0f) );
-        glm::mat4 mvp1 = project * modelview1;
-
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo0);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, varray0.size() * sizeof(*varray0.data()), varray0.data());
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-        glUniformBlockBinding(program, block, bind0);
-
-        glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, glm::value_ptr(mvp1));
-        // glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo1);
-        GLsizei N1 = (GLsizei)varray0.size()-2;
-        glDrawArrays(GL_TRIANGLES, 0, 6*(N1-1));
-
-        // line2
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        modelview1 = glm::mat4( 1.0f );
-        modelview1 = glm::translate(modelview1, glm::vec3(-1.0f, -0.6f, 0.0f) );
-        modelview1 = glm::scale(modelview1, glm::vec3(0.2f, 0.2f, 1.0f) );
-        mvp1 = project * modelview1;
-
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo0);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, varray0.size() * sizeof(*varray0.data()), varray0.data());
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-        glUniformBlockBinding(program, block, bind0);
-
-        glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, glm::value_ptr(mvp1));
-        // glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo1);
-        N1 = (GLsizei)varray0.size()-2;
-        glDrawArrays(GL_TRIANGLES, 0, 6*(N1-1));
-
-        // rectangle1
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        modelview1 = glm::mat4( 1.0f );
-        modelview1 = glm::translate(modelview1, glm::vec3(0.0f, 0.6f, 0.0f) );
-        modelview1 = glm::scale(modelview1, glm::vec3(0.3f, 0.3f, 1.0f) );
-        mvp1 = project * modelview1;
-
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo1);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, varray1.size() * sizeof(*varray1.data()), varray1.data());
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-        glUniformBlockBinding(program, block, bind);
-
-        glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, glm::value_ptr(mvp1));
-        // glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo1);
-        N1 = (GLsizei)varray1.size()-2;
-        glDrawArrays(GL_TRIANGLES, 0, 6*(N1-1));
-
-        // rectangle2
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        modelview1 = glm::mat4( 1.0f );
-        modelview1 = glm::translate(modelview1, glm::vec3(0.0f, -0.6f, 0.0f) );
-        modelview1 = glm::scale(modelview1, glm::vec3(0.3f, 0.3f, 1.0f) );
-        mvp1 = project * modelview1;
-
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo1);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, varray1.size() * sizeof(*varray1.data()), varray1.data());
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-        glUniformBlockBinding(program, block, bind);
-
-        glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, glm::value_ptr(mvp1));
-        // glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo1);
-        N1 = (GLsizei)varray1.size()-2;
-        glDrawArrays(GL_TRIANGLES, 0, 6*(N1-1));
-
-        // circle1
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glm::mat4 modelview2( 1.0f );
-        modelview2 = glm::translate(modelview2, glm::vec3(1.0f, 0.6f, 0.0f) );
-        modelview2 = glm::scale(modelview2, glm::vec3(0.3f, 0.3f, 1.0f) );
-        glm::mat4 mvp2 = project * modelview2;
+    size_t frame = 0;
 
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo2);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, varray2.size() * sizeof(*varray2.data()), varray2.data());
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-        glUniformBlockBinding(program, block, bind2);
-        
-        glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, glm::value_ptr(mvp2));
-        // glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo2);
-        GLsizei N2 = (GLsizei)varray2.size()-2;
-        glDrawArrays(GL_TRIANGLES, 0, 6*(N2-1));
+    while (headless ? frame < headless_frames : !glfwWindowShouldClose(window))
+    {
+        frame_times.begin();
+        if (shader_watcher)
+        {
+            std::vector<std::string> changed;
+            for (const std::string &path : shader_watcher->takeChanges())
+            {
+                changed.push_back(shader_loader.getName(path));
+                shader_loader.override(changed.back());
+            }
+            if (!changed.empty())
+            {
+                debug("shaders changed, reloading...");
+                permutations.reload(changed);
+            }
+        }
+        if (pollShaderProgram(uniformblock_frame, false) && program_linked)
+        {
+            program_linked = false;
+            uniformblock_frame.setUniforms();
+        }
 
-        // circle2
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        modelview2 = glm::mat4( 1.0f );
-        modelview2 = glm::translate(modelview2, glm::vec3(1.0f, -0.6f, 0.0f) );
-        modelview2 = glm::scale(modelview2, glm::vec3(0.3f, 0.3f, 1.0f) );
-        mvp2 = project * modelview2;
+        int w, h;
+        glfwGetFramebufferSize(window, &w, &h);
+        uniformblock_frame.draw(state_cache, w, h);
 
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo2);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, varray2.size() * sizeof(*varray2.data()), varray2.data());
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-        glUniformBlockBinding(program, block, bind2);
-        
-        glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, glm::value_ptr(mvp2));
-        // glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo2);
-        N2 = (GLsizei)varray2.size()-2;
-        glDrawArrays(GL_TRIANGLES, 0, 6*(N2-1));
-        glfwSwapBuffers(window);
+        StateUtils::StateCounters counters = state_cache.endFrame();
+        if (frame++ % 300 == 0)
+            debug("state calls: " << counters.issued << " issued, " << counters.elided << " elided");
+        if (headless)
+        {
+            // The frame time includes the rendering
+            glFinish();
+            frame_times.end();
+        }
+        else
+        {
+            glfwSwapBuffers(window);
+        }
         glfwPollEvents();
     }
 
+    if (headless)
+    {
+        frame_times.report("uniformblock");
+        info("last frame checksum: " << std::hex << offscreen->checksum() << std::dec);
+    }
+    offscreen.reset();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "uniformblock_frame.h"
+#include "../../glm/glm/gtc/matrix_transform.hpp"
+#include <Base/gl_dispatch.h>
+#include <iostream>
+#include <math.h>
+
+// Set on each program linked, see setUniforms
+const GLfloat thickness = 20.0f;
+// Dashes along the arc length, one pattern bit every `factor` model units
+const GLushort pattern = 0x18ff;
+const GLfloat factor = 0.1f;
+// The uniform buffer binding of the pages
+const GLuint bind0 = 0;
+
+// The uniforms and blocks of the shaders, looked up in the reflection of the program
+constexpr uint32_t U_MVP = ShaderUtils::hashName("u_mvp");
+constexpr uint32_t U_RESOLUTION = ShaderUtils::hashName("u_resolution");
+constexpr uint32_t U_THICKNESS = ShaderUtils::hashName("u_thickness");
+constexpr uint32_t U_OFFSET = ShaderUtils::hashName("u_offset");
+constexpr uint32_t U_PATTERN = ShaderUtils::hashName("u_pattern");
+constexpr uint32_t U_FACTOR = ShaderUtils::hashName("u_factor");
+constexpr uint32_t BLOCK_RECT = ShaderUtils::hashName("BlockRect");
+
+const char *VERTEX_SHADER = "vertex_shader.glsl";
+const char *FRAGMENT_SHADER = "fragment_shader.glsl";
+
+UniformBlockFrame::UniformBlockFrame()
+{
+    glm::vec4 p00(-1.0f, -0.5f, 0.0f, 1.0f);
+    glm::vec4 p01(-0.5f,  0.5f, 0.0f, 1.0f);
+    glm::vec4 p02( 0.0f, -0.5f, 0.0f, 1.0f);
+    glm::vec4 p03( 0.5f,  0.5f, 0.0f, 1.0f);
+    glm::vec4 p04( 1.0f, -0.5f, 0.0f, 1.0f);
+    glm::vec4 p05( 1.5f,  0.5f, 0.0f, 1.0f);
+    glm::vec4 p06( 2.0f, -0.5f, 0.0f, 1.0f);
+    glm::vec4 p07( 2.5f,  0.5f, 0.0f, 1.0f);
+
+    std::vector<glm::vec4> varray0{p00, p01, p02, p03, p04, p05, p06, p07};
+
+    glm::vec4 p0(-1.0f, -1.0f, 0.0f, 1.0f);
+    glm::vec4 p1(1.0f, -1.0f, 0.0f, 1.0f);
+    glm::vec4 p2(1.0f, 1.0f, 0.0f, 1.0f);
+    glm::vec4 p3(-1.0f, 1.0f, 0.0f, 1.0f);
+    std::vector<glm::vec4> varray1{ p3, p0, p1, p2, p3, p0, p1 };
+
+    std::vector<glm::vec4> varray2;
+    for (int u=-8; u <= 368; u += 8)
+    {
+        double a = u*M_PI/180.0;
+        double c = cos(a), s = sin(a);
+        varray2.emplace_back(glm::vec4((float)c, (float)s, 0.0f, 1.0f));
+        std::cout << "u = " << u << ", a = " << a << " (" << c << ", " << s << ")" << std::endl;
+    }
+
+    // All the polylines in pages of a single UBO, sent once
+    const std::size_t line0 = pages.add(varray0.data(), varray0.size());
+    const std::size_t line1 = pages.add(varray1.data(), varray1.size());
+    const std::size_t line2 = pages.add(varray2.data(), varray2.size());
+    pages.upload();
+
+    instances = {
+        {line0, GL_LINE, glm::vec3(-1.0f, 0.6f, 0.0f), 0.2f},  // line1
+        {line0, GL_FILL, glm::vec3(-1.0f, -0.6f, 0.0f), 0.2f}, // line2
+        {line1, GL_LINE, glm::vec3(0.0f, 0.6f, 0.0f), 0.3f},   // rectangle1
+        {line1, GL_FILL, glm::vec3(0.0f, -0.6f, 0.0f), 0.3f},  // rectangle2
+        {line2, GL_LINE, glm::vec3(1.0f, 0.6f, 0.0f), 0.3f},   // circle1
+        {line2, GL_FILL, glm::vec3(1.0f, -0.6f, 0.0f), 0.3f}}; // circle2
+
+    GLUtils::gl().GenVertexArrays(1, &vao);
+    GLUtils::gl().ClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void UniformBlockFrame::createProgram(ShaderUtils::PermutationCache &permutations)
+{
+    const ShaderUtils::Defines miter = {{"LINE_MITER", ""}};
+    const ShaderUtils::Defines dash = {{"LINE_DASH", ""}};
+    program = &permutations.get(VERTEX_SHADER, FRAGMENT_SHADER, miter, dash);
+}
+
+const ShaderUtils::Program &UniformBlockFrame::getProgram() const
+{
+    return *program;
+}
+
+void UniformBlockFrame::setUniforms()
+{
+    // A reload links a new program: its uniforms start from their defaults
+    program->setUniform(U_THICKNESS, thickness);
+    program->setUniform(U_PATTERN, (GLint)pattern);
+    program->setUniform(U_FACTOR, factor);
+    program->bindUniformBlock(BLOCK_RECT, bind0);
+    // The resolution too, with the viewport of the next frame
+    viewport[0] = viewport[1] = 0;
+}
+
+void UniformBlockFrame::draw(StateUtils::StateCache &state, int width, int height)
+{
+    state.useProgram(program->getProgram().value());
+    state.bindVertexArray(vao);
+    if (width != viewport[0] || height != viewport[1])
+    {
+        viewport[0] = width; viewport[1] = height;
+        GLUtils::gl().Viewport(0, 0, viewport[0], viewport[1]);
+        float aspect = (float)width/(float)height;
+        project = glm::ortho(-aspect, aspect, -1.0f, 1.0f, -10.0f, 10.0f);
+        state.uniform2f(program->getUniformLocation(U_RESOLUTION), (float)width, (float)height);
+    }
+
+    GLUtils::gl().Clear(GL_COLOR_BUFFER_BIT);
+
+    // One binding per page, then every piece of polyline stored in it
+    for (std::size_t page = 0; page < pages.getPageCount(); page++)
+    {
+        pages.bindPage(page, bind0);
+        for (const LineInstance &instance : instances)
+        {
+            glm::mat4 modelview(1.0f);
+            modelview = glm::translate(modelview, instance.translation);
+            modelview = glm::scale(modelview, glm::vec3(instance.scale, instance.scale, 1.0f));
+            glm::mat4 mvp = project * modelview;
+
+            for (const LineUtils::PageDraw &draw : pages.getDraws(instance.line))
+            {
+                if (draw.page != page)
+                    continue;
+                GLUtils::gl().PolygonMode(GL_FRONT_AND_BACK, instance.mode);
+                state.uniformMatrix4(program->getUniformLocation(U_MVP), mvp);
+                state.uniform1i(program->getUniformLocation(U_OFFSET), draw.offset);
+                GLUtils::gl().DrawArrays(GL_TRIANGLES, 0, draw.vertexCount);
+            }
+        }
+    }
+}
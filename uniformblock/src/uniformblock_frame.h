@@ -0,0 +1,78 @@
+#ifndef _UNIFORMBLOCK_FRAME_H
+#define _UNIFORMBLOCK_FRAME_H
+
+#include <cstddef>
+#include <vector>
+#include "../../glm/glm/glm.hpp"
+#include <Base/shader_utils.h>
+#include <Base/shader_preprocessor.h>
+#include <Base/line_pages.h>
+#include <Base/state_cache.h>
+
+/**
+ * @brief The scene of the uniformblock demo: three polylines in the pages of a uniform block,
+ * each drawn twice, outlined then filled. Every GL call goes through GLUtils::gl(): the
+ * benchmark records these frames.
+ */
+struct UniformBlockFrame
+{
+
+private:
+    /**
+     * @brief The polyline, polygon mode, position and scale of each draw
+     */
+    struct LineInstance
+    {
+        std::size_t line;
+        GLenum mode;
+        glm::vec3 translation;
+        float scale;
+    };
+
+    ShaderUtils::Program *program = nullptr;
+    LineUtils::LinePages pages;
+    std::vector<LineInstance> instances;
+    GLuint vao = 0;
+
+    /**
+     * @brief The framebuffer size the projection was computed for
+     */
+    int viewport[2] = {0, 0};
+    glm::mat4 project = glm::mat4(1.0f);
+
+public:
+    /**
+     * @brief Constructor, uploads the polylines: a context must be current, or the calls recorded
+     */
+    UniformBlockFrame();
+
+    UniformBlockFrame(const UniformBlockFrame &) = delete;
+    UniformBlockFrame &operator=(const UniformBlockFrame &) = delete;
+
+    /**
+     * @brief Submits the program to a cache whose preprocessor loads the demo's shaders: the
+     * joins are mitered and the lines dashed
+     */
+    void createProgram(ShaderUtils::PermutationCache &permutations);
+
+    /**
+     * @brief Returns the program submitted by `createProgram`
+     */
+    const ShaderUtils::Program &getProgram() const;
+
+    /**
+     * @brief Sets the uniforms which don't change between frames, once the program is linked
+     */
+    void setUniforms();
+
+    /**
+     * @brief Draws a frame, after the program is linked
+     *
+     * @param state - the state cache, which elides the calls repeated since the last frame
+     * @param width - the width of the framebuffer, the viewport and projection follow it
+     * @param height - the height of the framebuffer
+     */
+    void draw(StateUtils::StateCache &state, int width, int height);
+};
+
+#endif /* _UNIFORMBLOCK_FRAME_H */